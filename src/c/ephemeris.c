@@ -0,0 +1,288 @@
+#include "ephemeris.h"
+#include "lunar_series.h"
+//
+// Adapted from the javascript code below to C
+//
+// https://github.com/mourner/suncalc/blob/master/suncalc.js
+//
+//
+// (c) 2011-2015, Vladimir Agafonkin
+// SunCalc is a JavaScript library for calculating sun/moon position and light phases.
+// https://github.com/mourner/suncalc
+//
+// sun calculations are based on http://aa.quae.nl/en/reken/zonpositie.html formulas
+
+
+float sin_pebble(float angle_radians) {
+  int32_t angle_pebble = angle_radians * TRIG_MAX_ANGLE / (2*PI);
+  return ((float)(sin_lookup(angle_pebble)) / (float)TRIG_MAX_RATIO);
+}
+
+float sqrt_pebble(float input) {
+  if (input <= 0) return 0;
+  // first guess from halving the exponent, then two Newton steps
+  union { float f; uint32_t i; } guess = { input };
+  guess.i = (guess.i >> 1) + 0x1fc00000;
+  float root = guess.f;
+  root = 0.5f * (root + input / root);
+  root = 0.5f * (root + input / root);
+  return root;
+}
+
+// Abramowitz & Stegun 4.4.45: acos(x) = sqrt(1-x) * P(x) for 0 <= x <= 1,
+// |error| < 7e-5 radians (0.004 degrees)
+static float prv_acos_positive(float x) {
+  float p = ((-0.0187293f * x + 0.0742610f) * x - 0.2121144f) * x + 1.5707288f;
+  return sqrt_pebble(1 - x) * p;
+}
+
+float asin_pebble(float ratio) {
+  if (ratio >= 1) return PI/2;
+  if (ratio <= -1) return -PI/2;
+  if (ratio < 0) return prv_acos_positive(-ratio) - (float)(PI/2);
+  return (float)(PI/2) - prv_acos_positive(ratio);
+}
+
+float acos_pebble(float ratio) {
+  return (float)(PI/2) - asin_pebble(ratio);
+}
+
+float cos_pebble(float angle_radians) {
+  int32_t angle_pebble = angle_radians * TRIG_MAX_ANGLE / (2*PI);
+  return ((float)cos_lookup(angle_pebble) / (float)TRIG_MAX_RATIO);
+}
+
+// Abramowitz & Stegun 4.4.49: atan on the first octant, unfolded to the
+// full circle.  Works for any input magnitude, |error| < 1.5e-5 radians
+// (1e-5 of it the polynomial's, the rest float rounding).  Returns -PI to PI.
+float atan2_pebble(float y, float x) {
+  float abs_x = fabs_pebble(x);
+  float abs_y = fabs_pebble(y);
+  if (abs_x == 0 && abs_y == 0) return 0;
+  float a = (abs_x < abs_y) ? abs_x / abs_y : abs_y / abs_x;
+  float s = a * a;
+  float r = ((((0.0208351f * s - 0.0851330f) * s + 0.1801410f) * s - 0.3302995f) * s + 0.9998660f) * a;
+  if (abs_y > abs_x) r = (float)(PI/2) - r;
+  if (x < 0) r = (float)PI - r;
+  if (y < 0) r = -r;
+  return r;
+}
+
+float fmod_pebble(float product, float divisor) {
+  int32_t factor;
+  float remainder;
+  
+  factor = (int32_t)(product/divisor);
+  if (product<0) factor--;    // casting to int truncates so check if negative and decrement
+  remainder = product - ((float)factor)*divisor;
+  return remainder;
+}
+
+float fabs_pebble(float input) {
+  float sign;
+  
+  if (input<0) sign = -1;
+  else sign = 1;
+    
+  return (sign*input);
+}
+
+int round_to_int(float input) {  
+  if (input>0)
+    return (int)(input+0.5);
+  else
+    return (int)(input-0.5);  
+}
+
+float toDays(time_t unixdate) {
+  return ((float)(unixdate-J2000) / SECS_IN_DAY -0.5);
+}
+
+// observer context
+
+void observer_init(Observer *obs, float latitude, float longitude) {
+  obs->Latitude = latitude;
+  obs->Longitude = longitude;
+  obs->phi = DEG2RAD * latitude;
+  obs->lw = DEG2RAD * -1*longitude;
+  obs->sin_phi = sin_pebble(obs->phi);
+  obs->cos_phi = cos_pebble(obs->phi);
+  obs->phi_angle = (int32_t)(latitude * (TRIG_MAX_ANGLE / 360.0f));
+  obs->lw_angle = -(int32_t)(longitude * (TRIG_MAX_ANGLE / 360.0f));
+  obs->sin_phi_q15 = sin_lookup(obs->phi_angle) >> 1;
+  obs->cos_phi_q15 = cos_lookup(obs->phi_angle) >> 1;
+  obs->valid = true;
+}
+
+bool observer_set(Observer *obs, float latitude, float longitude) {
+  if (obs->valid && (obs->Latitude == latitude) && (obs->Longitude == longitude))
+    return false;
+  observer_init(obs, latitude, longitude);
+  return true;
+}
+
+// general calculations for position
+
+float rightAscension(float l, float b) {
+  return atan2_pebble(sin_pebble(l) * COS_E - sin_pebble(b)/cos_pebble(b) * SIN_E, cos_pebble(l));
+}
+
+float declination(float l, float b) { 
+  return (asin_pebble(sin_pebble(b) * COS_E + cos_pebble(b) * SIN_E * sin_pebble(l)));
+}
+
+float azimuth(float H, const Observer *obs, float dec) {
+  return (atan2_pebble(sin_pebble(H), cos_pebble(H) * obs->sin_phi - sin_pebble(dec)/cos_pebble(dec) * obs->cos_phi));
+}
+
+float altitude(float H, const Observer *obs, float dec) { 
+  return (asin_pebble(obs->sin_phi * sin_pebble(dec) + obs->cos_phi * cos_pebble(dec) * cos_pebble(H))); 
+}
+
+float siderealTime(float d, float lw) { 
+  return (DEG2RAD * (280.16 + 360.9856235 * d) - lw);
+}
+
+// general sun calculations
+
+static float solarMeanAnomaly(float d) { 
+  return (DEG2RAD * (357.5291 + 0.98560028 * d)); 
+}
+
+static float eclipticLongitude(float M) {
+  float C = DEG2RAD * (1.9148 * sin_pebble(M) + 0.02 * sin_pebble(2 * M) + 0.0003 * sin_pebble(3 * M)); // equation of center
+  float P = DEG2RAD * 102.9372; // perihelion of the Earth
+  return (M + C + P + PI);
+}
+
+void sunCoords(float d, float *dec, float *ra) {
+
+  float M = solarMeanAnomaly(d);
+  float L = eclipticLongitude(M);
+
+  *dec = declination(L, 0);
+  *ra = rightAscension(L, 0);
+}
+
+void sunPositionFloat(const Observer *obs, time_t unixdate, int calc_azi, float *azi, float *alt) {
+// calculates sun position for a given date and observer latitude/longitude
+
+  float d = toDays(unixdate);
+
+  float dec, ra;
+  sunCoords(d, &dec, &ra);
+  float H  = siderealTime(d, obs->lw) - ra;
+
+  *alt = altitude(H, obs, dec) * RAD2DEG;
+  if (calc_azi == CALC_AZI)
+    *azi = fmod_pebble(((azimuth(H, obs, dec) + PI) * RAD2DEG ),360);
+}
+
+// moon calculations, based on http://aa.quae.nl/en/reken/hemelpositie.html formulas
+
+// A lunar series row with the amplitudes in radians
+typedef struct LunarTermFloat {
+  int8_t D, M, Mp, F;
+  float amplitude;
+  float parallax;
+} LunarTermFloat;
+
+#define LUNAR_TERM_FLOAT(D, M, Mp, F, micro, metres) \
+  { D, M, Mp, F, DEG2RAD * LUNAR_DEGREES_OF(micro), DEG2RAD * LUNAR_PARALLAX_OF(metres) },
+static const LunarTermFloat LUNAR_LONGITUDE[] = { LUNAR_LONGITUDE_SERIES(LUNAR_TERM_FLOAT) };
+static const LunarTermFloat LUNAR_LATITUDE[] = { LUNAR_LATITUDE_SERIES(LUNAR_TERM_FLOAT) };
+
+static float prv_lunar_argument(const LunarTermFloat *term, float D, float M, float Mp, float F) {
+  return term->D * D + term->M * M + term->Mp * Mp + term->F * F;
+}
+
+void moonCoords(float d, float *ra, float *dec, float *parallax) { 
+// geocentric ecliptic coordinates of the moon, with the first LUNAR_TERMS
+// terms of the series in lunar_series.h
+
+  float L = DEG2RAD * (LUNAR_L_BASE + LUNAR_L_RATE * d); // mean longitude
+  float D = DEG2RAD * (LUNAR_D_BASE + LUNAR_D_RATE * d); // mean elongation
+  float M = DEG2RAD * (LUNAR_M_BASE + LUNAR_M_RATE * d); // sun's mean anomaly
+  float Mp = DEG2RAD * (LUNAR_MP_BASE + LUNAR_MP_RATE * d); // mean anomaly
+  float F = DEG2RAD * (LUNAR_F_BASE + LUNAR_F_RATE * d); // argument of latitude
+
+  float l = L;                                     // longitude
+  float b = 0;                                     // latitude
+  float p = DEG2RAD * LUNAR_PARALLAX_MEAN;         // horizontal parallax
+  for (int i = 0; i < LUNAR_TERMS; i++) {
+    const LunarTermFloat *term = &LUNAR_LONGITUDE[i];
+    float arg = prv_lunar_argument(term, D, M, Mp, F);
+    l += term->amplitude * sin_pebble(arg);
+    if (i < LUNAR_PARALLAX_TERMS)
+      p += term->parallax * cos_pebble(arg);
+    term = &LUNAR_LATITUDE[i];
+    b += term->amplitude * sin_pebble(prv_lunar_argument(term, D, M, Mp, F));
+  }
+
+  *ra = rightAscension(l, b);
+  *dec = declination(l, b);
+  *parallax = p;
+}
+
+void moonPositionFloat(const Observer *obs, time_t unixdate, int calc_azi, float *azi, float *alt) {
+  float d = toDays(unixdate);
+
+  float ra, dec, parallax;
+  moonCoords(d, &ra, &dec, &parallax);
+  float H = siderealTime(d, obs->lw) - ra;
+  float h = altitude(H, obs, dec);
+// formula 14.1 of "Astronomical Algorithms" 2nd edition by Jean Meeus (Willmann-Bell, Richmond) 1998.
+  // seen from the surface rather than the centre of the Earth
+  h -= parallax * cos_pebble(h);
+
+  *alt = h * RAD2DEG;
+  if (calc_azi == CALC_AZI)
+    *azi = fmod_pebble(((azimuth(H, obs, dec) + PI) * RAD2DEG ),360);
+}
+
+// Greatly simplified moon phase algorithm from
+// http://jivebay.com/calculating-the-moon-phase/
+// This simply takes a new moon and uses the moon cycle from there.
+// The function returns an integer between 0 and 29 that is the days
+// into the lunar cycle.  Thus, 0 is new moon, 15 is full moon, and 29 is new
+// note that in seconds, the lunar period, which is 29.5305882 earth days is
+// lunar period = 2551443 seconds
+
+float moonPhase(time_t unixdate) {
+  // 2016-Nov-29 12:19:25 UTC was a new moon
+  // 2016-Nov-29 12:19:25 UTC 1480421975 seconds (unix time)
+  // so mod the current unix timestamp minus this moon with the lunar period
+  // then convert to days by dividing by seconds in a day.
+  return ((float)((unixdate-1480421975)%MOONPERIOD_SEC)/(SECS_IN_DAY));
+
+}
+
+// Kernel selection.  The integer kernel only converts to degrees at the end.
+
+static float prv_angle_to_degrees(int32_t angle) {
+  return (float)angle * (360.0f / TRIG_MAX_ANGLE);
+}
+
+void sunPosition(const Observer *obs, time_t unixdate, int calc_azi, float *azi, float *alt) {
+#ifdef EPHEMERIS_FIXED_KERNEL
+  int32_t azi_angle, alt_angle;
+  sunPositionFixed(obs, unixdate, calc_azi, &azi_angle, &alt_angle);
+  *alt = prv_angle_to_degrees(alt_angle);
+  if (calc_azi == CALC_AZI)
+    *azi = prv_angle_to_degrees(azi_angle);
+#else
+  sunPositionFloat(obs, unixdate, calc_azi, azi, alt);
+#endif
+}
+
+void moonPosition(const Observer *obs, time_t unixdate, int calc_azi, float *azi, float *alt) {
+#ifdef EPHEMERIS_FIXED_KERNEL
+  int32_t azi_angle, alt_angle;
+  moonPositionFixed(obs, unixdate, calc_azi, &azi_angle, &alt_angle);
+  *alt = prv_angle_to_degrees(alt_angle);
+  if (calc_azi == CALC_AZI)
+    *azi = prv_angle_to_degrees(azi_angle);
+#else
+  moonPositionFloat(obs, unixdate, calc_azi, azi, alt);
+#endif
+}
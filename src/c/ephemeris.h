@@ -0,0 +1,131 @@
+#pragma once
+#include "sky_sdk.h"
+//
+// Ephemeris core: solar and lunar positions for an explicit observer.
+// Nothing in here touches the watchface state, so it can also be built
+// on the host (see tools/host/pebble.h) for profiling.
+//
+
+// date/time constants and conversions
+#define PI 3.14159268
+#define DEG2RAD 0.017453293
+#define RAD2DEG 57.29577903
+// degrees to radians = pi / 180 and rad to deg = 180 / pi
+#define J2000 946684800
+// year 2000 in unix time
+#define MOONPERIOD_SEC 2551443
+#define MOONPERIOD_DAYS 29.530587981
+#define TILT_OF_EARTH 23.4397
+#define SECS_IN_DAY 86400
+// day in seconds = 24*60*60
+#define SECS_IN_HOUR 3600
+// hour in seconds = 60*60
+#define NO_AZI 0
+#define CALC_AZI 1
+
+// Position kernel used by sunPosition/moonPosition, chosen at build time.
+// The watches have no FPU, so the integer kernel is the default; define
+// EPHEMERIS_FLOAT_KERNEL to build with the floating point one instead.
+#ifndef EPHEMERIS_FLOAT_KERNEL
+#define EPHEMERIS_FIXED_KERNEL
+#endif
+
+// Rows of each lunar series (lunar_series.h) the moon is computed with,
+// also chosen at build time.  Each row costs a lookup or two per position;
+// tools/bench/bench_lunar.c gives the accuracy and cost of each count.
+// Aplite keeps the evection, variation and the largest latitude terms.
+#ifndef LUNAR_TERMS
+#ifdef PBL_PLATFORM_APLITE
+#define LUNAR_TERMS 4
+#else
+#define LUNAR_TERMS 12
+#endif
+#endif
+
+// Where the sky is seen from, with the trig of the location cached for
+// both kernels.  Fill it in with observer_init() or observer_set().
+typedef struct Observer {
+  float Latitude;       // degrees, + for North
+  float Longitude;      // degrees, + for East
+  bool valid;           // derived values below are up to date
+  // float kernel, radians
+  float phi;
+  float lw;             // west longitude
+  float sin_phi;
+  float cos_phi;
+  // integer kernel, trig units and Q15
+  int32_t phi_angle;
+  int32_t lw_angle;
+  int32_t sin_phi_q15;
+  int32_t cos_phi_q15;
+} Observer;
+
+// sine and cosine of the obliquity of the ecliptic (TILT_OF_EARTH)
+#define SIN_E 0.3977837f
+#define COS_E 0.9174792f
+#define SIN_E_Q15 13034
+#define COS_E_Q15 30063
+
+// Compute the derived observer values for a location
+void observer_init(Observer *obs, float latitude, float longitude);
+// Same, but only when the location differs from the cached one.
+// Returns true if the observer was (re)computed.
+bool observer_set(Observer *obs, float latitude, float longitude);
+
+// trig and math helpers built on the pebble integer lookups
+float sin_pebble(float angle_radians);
+float cos_pebble(float angle_radians);
+// inverse trig in radians, polynomial approximations: asin and acos good to
+// 7e-5 radians, atan2 to 1.5e-5
+float asin_pebble(float ratio);
+float acos_pebble(float ratio);
+float atan2_pebble(float y, float x);
+float sqrt_pebble(float input);
+float fmod_pebble(float product, float divisor);
+float fabs_pebble(float input);
+int round_to_int(float input);
+
+// days since J2000 (noon based)
+float toDays(time_t unixdate);
+
+// general calculations for position, all angles in radians
+float rightAscension(float l, float b);
+float declination(float l, float b);
+float azimuth(float H, const Observer *obs, float dec);
+float altitude(float H, const Observer *obs, float dec);
+float siderealTime(float d, float lw);
+
+// sun and moon positions in degrees, through the selected kernel
+void sunPosition(const Observer *obs, time_t unixdate, int calc_azi, float *azi, float *alt);
+void moonPosition(const Observer *obs, time_t unixdate, int calc_azi, float *azi, float *alt);
+
+// floating point kernel, angles in radians (ephemeris.c)
+void sunCoords(float d, float *dec, float *ra);
+void sunPositionFloat(const Observer *obs, time_t unixdate, int calc_azi, float *azi, float *alt);
+// moon positions are topocentric: the altitude is lowered by the
+// horizontal parallax (returned by moonCoords) times cos(altitude)
+void moonCoords(float d, float *ra, float *dec, float *parallax);
+void moonPositionFloat(const Observer *obs, time_t unixdate, int calc_azi, float *azi, float *alt);
+
+// integer inverse trig: Q15 ratio in, TRIG_MAX_ANGLE units out
+int32_t asin_angle(int32_t ratio_q15);
+int32_t acos_angle(int32_t ratio_q15);
+// square root of a Q15 ratio, Q15
+int32_t sqrt_q15(int32_t ratio_q15);
+
+// integer kernel, angles in TRIG_MAX_ANGLE units (ephemeris_fixed.c)
+// altitude is signed, azimuth runs from 0 to TRIG_MAX_ANGLE
+void sunCoordsFixed(time_t unixdate, int32_t *dec, int32_t *ra);
+void sunPositionFixed(const Observer *obs, time_t unixdate, int calc_azi, int32_t *azi, int32_t *alt);
+void moonCoordsFixed(time_t unixdate, int32_t *ra, int32_t *dec, int32_t *parallax);
+void moonPositionFixed(const Observer *obs, time_t unixdate, int calc_azi, int32_t *azi, int32_t *alt);
+// illuminated fraction of the moon's disc (Q15), and the direction of its
+// bright limb as seen, counterclockwise from the zenith in trig units
+void moonIlluminationFixed(const Observer *obs, time_t unixdate, int32_t *lit_q15, int32_t *limb_angle);
+// local sidereal time (sidereal time less west longitude), trig units
+int32_t siderealAngle(const Observer *obs, time_t unixdate);
+// trig units to hundredths of a degree, truncated like (int)(100*degrees)
+int32_t angle_to_x100(int32_t angle);
+
+// days into the lunar cycle, 0 to 29.5
+float moonPhase(time_t unixdate);
@@ -0,0 +1,257 @@
+#include "ephemeris.h"
+#include "lunar_series.h"
+//
+// Integer-only version of the position kernel in ephemeris.c.
+//
+// Same formulas (suncalc's, with the moon from lunar_series.h), but angles
+// stay in pebble trig units (TRIG_MAX_ANGLE per turn) and sines/cosines in
+// Q15 (so that products of two of them fit in 32 bits)
+// from the timestamp all the way to the result, so the FPU-less watches
+// never touch soft-float.  Two tricks keep it division free:
+//   - the slow linear terms (mean anomaly, sidereal time, ...) are evaluated
+//     as secs * rate with the rate in turns per second scaled by 2^48, which
+//     keeps ~1e-6 turn precision over the whole 32 bit time range
+//   - atan2 does not care about a common positive factor, so the tan(b)
+//     and tan(dec) terms are multiplied through by cos(b) and cos(dec)
+//
+
+#define ANGLE_MASK (TRIG_MAX_ANGLE - 1)
+// degrees to trig angle units, rounded at compile time
+#define ANGLE_OF(deg) ((int32_t)((deg) * TRIG_MAX_ANGLE / 360.0 + 0.5))
+// degrees per day to turns per second, scaled by 2^48
+#define TURN_RATE(deg_per_day) ((int64_t)((deg_per_day) / 360.0 / SECS_IN_DAY * 281474976710656.0 + 0.5))
+// degrees of amplitude to trig angle units per unit ratio, scaled by 2^4
+#define AMPLITUDE_Q4(deg) ((int32_t)((deg) * TRIG_MAX_ANGLE / 360.0 * 16.0 + 0.5))
+// Q15 sine/cosine from the Q16 lookups, and the Q15 product
+#define SIN_Q15(a) (sin_lookup(a) >> 1)
+#define COS_Q15(a) (cos_lookup(a) >> 1)
+#define MUL_Q15(a, b) (((a) * (b)) >> 15)
+// Q15 ratios are brought down to Q13 for atan2_lookup's int16 inputs
+#define Q15_TO_ATAN2(a) ((int16_t)((a) >> 2))
+
+// seconds since J2000 noon, the time base of toDays()
+static int32_t prv_secs(time_t unixdate) {
+  return (int32_t)(unixdate - J2000 - SECS_IN_DAY/2);
+}
+
+// base + rate * secs, wrapped to one turn
+static int32_t prv_linear_angle(int32_t secs, int32_t base, int64_t rate) {
+  return (base + (int32_t)(((int64_t)secs * rate) >> 32)) & ANGLE_MASK;
+}
+
+int32_t sqrt_q15(int32_t ratio_q15) {
+  // bitwise integer square root of the Q30 value gives Q15
+  uint32_t value = (uint32_t)ratio_q15 << 15;
+  uint32_t root = 0;
+  uint32_t bit = 1u << 30;
+  while (bit > value) bit >>= 2;
+  while (bit != 0) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+      root >>= 1;
+    bit >>= 2;
+  }
+  return (int32_t)root;
+}
+
+// asin(i/128) in trig units for ratios 0 to 0.875 (altitudes below 61 deg),
+// linear interpolation between entries is good to 0.004 degrees
+#define ASIN_TABLE_LIMIT (112 << 8)
+static const int16_t ASIN_TABLE[113] = {
+  0, 81, 163, 244, 326, 408, 489, 571, 652, 734, 816, 897,
+  979, 1061, 1143, 1225, 1307, 1389, 1472, 1554, 1636, 1719, 1802, 1884,
+  1967, 2050, 2134, 2217, 2300, 2384, 2468, 2551, 2636, 2720, 2804, 2889,
+  2974, 3059, 3144, 3229, 3315, 3401, 3487, 3573, 3660, 3747, 3834, 3922,
+  4009, 4097, 4186, 4275, 4364, 4453, 4543, 4633, 4723, 4814, 4905, 4997,
+  5089, 5181, 5274, 5367, 5461, 5556, 5651, 5746, 5842, 5938, 6035, 6133,
+  6231, 6330, 6430, 6530, 6631, 6732, 6835, 6938, 7042, 7147, 7252, 7359,
+  7466, 7575, 7684, 7795, 7907, 8019, 8133, 8249, 8365, 8483, 8602, 8723,
+  8846, 8970, 9095, 9223, 9353, 9484, 9618, 9754, 9892, 10034, 10177, 10324,
+  10475, 10628, 10785, 10947, 11113
+};
+
+// Above the table asin gets too steep to interpolate, so use the same
+// Abramowitz & Stegun 4.4.45 polynomial as asin_pebble(), with the
+// coefficients prescaled to trig units and kept in Q1
+#define ACOS_C0 32767   // 1.5707288 * TRIG_MAX_ANGLE / (2*PI) * 2
+#define ACOS_C1 -4425   // -0.2121144
+#define ACOS_C2 1549    //  0.0742610
+#define ACOS_C3 -391    // -0.0187293
+
+static int32_t prv_acos_positive(int32_t x) {
+  int32_t p = ACOS_C3;
+  p = ACOS_C2 + ((p * x) >> 15);
+  p = ACOS_C1 + ((p * x) >> 15);
+  p = ACOS_C0 + ((p * x) >> 15);
+  return (sqrt_q15(32768 - x) * p) >> 16;
+}
+
+static int32_t prv_asin_positive(int32_t x) {
+  if (x < ASIN_TABLE_LIMIT) {
+    int32_t i = x >> 8;
+    return ASIN_TABLE[i] + (((ASIN_TABLE[i+1] - ASIN_TABLE[i]) * (x & 0xff)) >> 8);
+  }
+  return TRIG_MAX_ANGLE/4 - prv_acos_positive(x);
+}
+
+int32_t asin_angle(int32_t ratio_q15) {
+  if (ratio_q15 >= 32768) return TRIG_MAX_ANGLE/4;
+  if (ratio_q15 <= -32768) return -TRIG_MAX_ANGLE/4;
+  if (ratio_q15 < 0) return -prv_asin_positive(-ratio_q15);
+  return prv_asin_positive(ratio_q15);
+}
+
+int32_t acos_angle(int32_t ratio_q15) {
+  return TRIG_MAX_ANGLE/4 - asin_angle(ratio_q15);
+}
+
+// ecliptic (l, b) to equatorial (ra, dec), all in trig units
+static void prv_equatorial(int32_t l, int32_t b, int32_t *ra, int32_t *dec) {
+  int32_t sin_l = SIN_Q15(l);
+  int32_t cos_l = COS_Q15(l);
+  int32_t sin_b = SIN_Q15(b);
+  int32_t cos_b = COS_Q15(b);
+
+  // rightAscension() scaled through by cos(b)
+  int32_t y = MUL_Q15(MUL_Q15(sin_l, COS_E_Q15), cos_b) - MUL_Q15(sin_b, SIN_E_Q15);
+  int32_t x = MUL_Q15(cos_l, cos_b);
+  *ra = atan2_lookup(Q15_TO_ATAN2(y), Q15_TO_ATAN2(x));
+
+  // declination()
+  int32_t sin_dec = MUL_Q15(sin_b, COS_E_Q15) + MUL_Q15(MUL_Q15(cos_b, SIN_E_Q15), sin_l);
+  *dec = asin_angle(sin_dec);
+}
+
+// horizontal coordinates from hour angle and declination
+static void prv_horizontal(int32_t H, const Observer *obs, int32_t dec, int calc_azi,
+                           int32_t *azi, int32_t *alt) {
+  int32_t sin_phi = obs->sin_phi_q15;
+  int32_t cos_phi = obs->cos_phi_q15;
+  int32_t sin_dec = SIN_Q15(dec);
+  int32_t cos_dec = COS_Q15(dec);
+  int32_t cos_H = COS_Q15(H);
+
+  *alt = asin_angle(MUL_Q15(sin_phi, sin_dec) + MUL_Q15(MUL_Q15(cos_phi, cos_dec), cos_H));
+  if (calc_azi == CALC_AZI) {
+    // azimuth() scaled through by cos(dec), then turned to measure from north
+    int32_t y = MUL_Q15(SIN_Q15(H), cos_dec);
+    int32_t x = MUL_Q15(MUL_Q15(cos_H, sin_phi), cos_dec) - MUL_Q15(sin_dec, cos_phi);
+    *azi = (atan2_lookup(Q15_TO_ATAN2(y), Q15_TO_ATAN2(x)) + TRIG_MAX_ANGLE/2) & ANGLE_MASK;
+  }
+}
+
+static int32_t prv_sidereal_angle(int32_t secs, int32_t lw) {
+  return (prv_linear_angle(secs, ANGLE_OF(280.16), TURN_RATE(360.9856235)) - lw) & ANGLE_MASK;
+}
+
+int32_t siderealAngle(const Observer *obs, time_t unixdate) {
+  return prv_sidereal_angle(prv_secs(unixdate), obs->lw_angle);
+}
+
+int32_t angle_to_x100(int32_t angle) {
+  return angle * 36000 / TRIG_MAX_ANGLE;
+}
+
+void sunCoordsFixed(time_t unixdate, int32_t *dec, int32_t *ra) {
+  int32_t secs = prv_secs(unixdate);
+  int32_t M = prv_linear_angle(secs, ANGLE_OF(357.5291), TURN_RATE(0.98560028));
+  // equation of center
+  int32_t C = (SIN_Q15(M) * AMPLITUDE_Q4(1.9148) +
+               SIN_Q15(2 * M) * AMPLITUDE_Q4(0.02) +
+               SIN_Q15(3 * M) * AMPLITUDE_Q4(0.0003)) >> 19;
+  // perihelion of the Earth plus half a turn
+  int32_t L = (M + C + ANGLE_OF(102.9372) + TRIG_MAX_ANGLE/2) & ANGLE_MASK;
+
+  prv_equatorial(L, 0, ra, dec);
+}
+
+void sunPositionFixed(const Observer *obs, time_t unixdate, int calc_azi, int32_t *azi, int32_t *alt) {
+  int32_t dec, ra;
+  sunCoordsFixed(unixdate, &dec, &ra);
+  int32_t H = prv_sidereal_angle(prv_secs(unixdate), obs->lw_angle) - ra;
+
+  prv_horizontal(H, obs, dec, calc_azi, azi, alt);
+}
+
+// A lunar series row with the amplitudes in AMPLITUDE_Q4 units
+typedef struct LunarTermFixed {
+  int8_t D, M, Mp, F;
+  int16_t amplitude;
+  int16_t parallax;
+} LunarTermFixed;
+
+#define LUNAR_TERM_FIXED(D, M, Mp, F, micro, metres) \
+  { D, M, Mp, F, AMPLITUDE_Q4(LUNAR_DEGREES_OF(micro)), AMPLITUDE_Q4(LUNAR_PARALLAX_OF(metres)) },
+static const LunarTermFixed LUNAR_LONGITUDE[] = { LUNAR_LONGITUDE_SERIES(LUNAR_TERM_FIXED) };
+static const LunarTermFixed LUNAR_LATITUDE[] = { LUNAR_LATITUDE_SERIES(LUNAR_TERM_FIXED) };
+
+static int32_t prv_lunar_argument(const LunarTermFixed *term, int32_t D, int32_t M, int32_t Mp, int32_t F) {
+  return (term->D * D + term->M * M + term->Mp * Mp + term->F * F) & ANGLE_MASK;
+}
+
+void moonCoordsFixed(time_t unixdate, int32_t *ra, int32_t *dec, int32_t *parallax) {
+  int32_t secs = prv_secs(unixdate);
+  int32_t L = prv_linear_angle(secs, ANGLE_OF(LUNAR_L_BASE), TURN_RATE(LUNAR_L_RATE));
+  int32_t D = prv_linear_angle(secs, ANGLE_OF(LUNAR_D_BASE), TURN_RATE(LUNAR_D_RATE));
+  int32_t M = prv_linear_angle(secs, ANGLE_OF(LUNAR_M_BASE), TURN_RATE(LUNAR_M_RATE));
+  int32_t Mp = prv_linear_angle(secs, ANGLE_OF(LUNAR_MP_BASE), TURN_RATE(LUNAR_MP_RATE));
+  int32_t F = prv_linear_angle(secs, ANGLE_OF(LUNAR_F_BASE), TURN_RATE(LUNAR_F_RATE));
+
+  // sums in Q15 * Q4, brought to trig units at the end
+  int32_t l_sum = 0, b_sum = 0;
+  int32_t p_sum = AMPLITUDE_Q4(LUNAR_PARALLAX_MEAN) << 15;
+  for (int i = 0; i < LUNAR_TERMS; i++) {
+    const LunarTermFixed *term = &LUNAR_LONGITUDE[i];
+    int32_t arg = prv_lunar_argument(term, D, M, Mp, F);
+    l_sum += SIN_Q15(arg) * term->amplitude;
+    if (i < LUNAR_PARALLAX_TERMS)
+      p_sum += COS_Q15(arg) * term->parallax;
+    term = &LUNAR_LATITUDE[i];
+    b_sum += SIN_Q15(prv_lunar_argument(term, D, M, Mp, F)) * term->amplitude;
+  }
+  int32_t l = (L + (l_sum >> 19)) & ANGLE_MASK; // longitude
+  int32_t b = b_sum >> 19;                      // latitude
+  *parallax = p_sum >> 19;
+
+  prv_equatorial(l, b, ra, dec);
+}
+
+void moonPositionFixed(const Observer *obs, time_t unixdate, int calc_azi, int32_t *azi, int32_t *alt) {
+  int32_t ra, dec, parallax;
+  moonCoordsFixed(unixdate, &ra, &dec, &parallax);
+  int32_t H = prv_sidereal_angle(prv_secs(unixdate), obs->lw_angle) - ra;
+
+  prv_horizontal(H, obs, dec, calc_azi, azi, alt);
+  *alt -= MUL_Q15(parallax, COS_Q15(*alt));
+}
+
+void moonIlluminationFixed(const Observer *obs, time_t unixdate, int32_t *lit_q15, int32_t *limb_angle) {
+  int32_t sun_dec, sun_ra, ra, dec, parallax;
+  sunCoordsFixed(unixdate, &sun_dec, &sun_ra);
+  moonCoordsFixed(unixdate, &ra, &dec, &parallax);
+  int32_t sin_sun_dec = SIN_Q15(sun_dec);
+  int32_t cos_sun_dec = COS_Q15(sun_dec);
+  int32_t sin_dec = SIN_Q15(dec);
+  int32_t cos_dec = COS_Q15(dec);
+  int32_t d_ra = sun_ra - ra;
+  int32_t cos_d_ra = COS_Q15(d_ra);
+
+  // elongation from the sun, and the phase angle taken as its supplement
+  int32_t cos_elongation = MUL_Q15(sin_sun_dec, sin_dec) + MUL_Q15(MUL_Q15(cos_sun_dec, cos_dec), cos_d_ra);
+  *lit_q15 = (32768 - cos_elongation) / 2;
+
+  // position angle of the bright limb from north (Meeus 48.5), less the
+  // parallactic angle (Meeus 14.1, scaled through by cos(phi)) to measure
+  // it from the zenith
+  int32_t y = MUL_Q15(cos_sun_dec, SIN_Q15(d_ra));
+  int32_t x = MUL_Q15(sin_sun_dec, cos_dec) - MUL_Q15(MUL_Q15(cos_sun_dec, sin_dec), cos_d_ra);
+  int32_t chi = atan2_lookup(Q15_TO_ATAN2(y), Q15_TO_ATAN2(x));
+  int32_t H = prv_sidereal_angle(prv_secs(unixdate), obs->lw_angle) - ra;
+  y = MUL_Q15(SIN_Q15(H), obs->cos_phi_q15);
+  x = MUL_Q15(obs->sin_phi_q15, cos_dec) - MUL_Q15(MUL_Q15(obs->cos_phi_q15, sin_dec), COS_Q15(H));
+  int32_t q = atan2_lookup(Q15_TO_ATAN2(y), Q15_TO_ATAN2(x));
+  *limb_angle = (chi - q) & ANGLE_MASK;
+}
@@ -0,0 +1,90 @@
+#pragma once
+//
+// Periodic terms of the lunar theory, from tables 47.A and 47.B of
+// "Astronomical Algorithms" 2nd edition by Jean Meeus (Willmann-Bell,
+// Richmond) 1998, largest first.  The kernels use the first LUNAR_TERMS
+// rows of each (see ephemeris.h); the rows are X-macro lists so that
+// the float and integer kernels, the host benches and the phone
+// (src/pkjs/sky_tables.js) all work from the same numbers.
+//
+// Each row is X(D, M, M', F, coefficient, distance): the multiples of the
+// fundamental arguments in the sine (or cosine) argument, then the term
+// in units of 1e-6 degrees and, for longitude rows, the cosine term of the
+// distance in metres.  The annual equation rows are really scaled by the
+// eccentricity factor E, which stays above 0.9999 this century and is
+// left out.
+//
+// Fundamental arguments, degrees and degrees per day since J2000 noon
+// (toDays()).  L, M' and F are suncalc's; M is sunCoords()'s.
+#define LUNAR_L_BASE 218.316     // mean longitude
+#define LUNAR_L_RATE 13.176396
+#define LUNAR_D_BASE 297.8502    // mean elongation
+#define LUNAR_D_RATE 12.19074912
+#define LUNAR_M_BASE 357.5291    // mean anomaly of the sun
+#define LUNAR_M_RATE 0.98560028
+#define LUNAR_MP_BASE 134.963    // mean anomaly
+#define LUNAR_MP_RATE 13.064993
+#define LUNAR_F_BASE 93.272      // argument of latitude
+#define LUNAR_F_RATE 13.229350
+
+// Horizontal parallax, linearised in the distance terms:
+// sin(p) = 6378.14 km / (385000.56 km + distance) is taken as
+// LUNAR_PARALLAX_MEAN * (1 - distance / 385000.56 km), good to 0.004 deg
+#define LUNAR_PARALLAX_MEAN 0.949203
+#define LUNAR_PARALLAX_OF(metres) (-LUNAR_PARALLAX_MEAN * (metres) / 385000560.0)
+#define LUNAR_DEGREES_OF(micro) ((micro) * 1e-6)
+
+// ecliptic longitude (sine) and distance (cosine), table 47.A
+#define LUNAR_LONGITUDE_SERIES(X) \
+  X(0,  0,  1,  0, 6288774, -20905355) \
+  X(2,  0, -1,  0, 1274027,  -3699111) \
+  X(2,  0,  0,  0,  658314,  -2955968) \
+  X(0,  0,  2,  0,  213618,   -569925) \
+  X(0,  1,  0,  0, -185116,     48888) \
+  X(0,  0,  0,  2, -114332,     -3149) \
+  X(2,  0, -2,  0,   58793,    246158) \
+  X(2, -1, -1,  0,   57066,   -152138) \
+  X(2,  0,  1,  0,   53322,   -170733) \
+  X(2, -1,  0,  0,   45758,   -204586) \
+  X(0,  1, -1,  0,  -40923,   -129620) \
+  X(1,  0,  0,  0,  -34720,    108743) \
+  X(0,  1,  1,  0,  -30383,    104755) \
+  X(2,  0,  0, -2,   15327,     10321) \
+  X(0,  0,  1,  2,  -12528,         0) \
+  X(0,  0,  1, -2,   10980,     79661) \
+  X(4,  0, -1,  0,   10675,    -34782) \
+  X(0,  0,  3,  0,   10034,    -23210) \
+  X(4,  0, -2,  0,    8548,    -21636) \
+  X(2,  1, -1,  0,   -7888,     24208)
+
+// ecliptic latitude (sine), table 47.B; the distance column is unused
+#define LUNAR_LATITUDE_SERIES(X) \
+  X(0,  0,  0,  1, 5128122, 0) \
+  X(0,  0,  1,  1,  280602, 0) \
+  X(0,  0,  1, -1,  277693, 0) \
+  X(2,  0,  0, -1,  173237, 0) \
+  X(2,  0, -1,  1,   55413, 0) \
+  X(2,  0, -1, -1,   46271, 0) \
+  X(2,  0,  0,  1,   32573, 0) \
+  X(0,  0,  2,  1,   17198, 0) \
+  X(2,  0,  1, -1,    9266, 0) \
+  X(0,  0,  2, -1,    8822, 0) \
+  X(2, -1,  0, -1,    8216, 0) \
+  X(2,  0, -2, -1,    4324, 0) \
+  X(2,  0,  1,  1,    4200, 0) \
+  X(2,  1,  0, -1,   -3359, 0) \
+  X(2, -1, -1,  1,    2463, 0) \
+  X(2, -1,  0,  1,    2211, 0) \
+  X(2, -1, -1, -1,    2065, 0) \
+  X(0,  1, -1, -1,   -1870, 0) \
+  X(4,  0, -1, -1,    1828, 0) \
+  X(0,  1,  0,  1,   -1794, 0)
+
+#define LUNAR_SERIES_ROWS 20
+#if (LUNAR_TERMS < 1) || (LUNAR_TERMS > LUNAR_SERIES_ROWS)
+#error "LUNAR_TERMS must be from 1 to LUNAR_SERIES_ROWS"
+#endif
+
+// Parallax only needs the large distance terms; past these the rest add
+// less than 0.001 degrees
+#define LUNAR_PARALLAX_TERMS 4
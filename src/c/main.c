@@ -1,4 +1,21 @@
 #include <pebble.h>
+#include "ephemeris.h"
+#include "sky_path.h"
+#include "sky_samples.h"
+#include "sky_bands.h"
+#include "position_cache.h"
+#include "render_state.h"
+#include "sky_cache.h"
+#include "sky_layout.h"
+#include "sky_events.h"
+#include "sky_store.h"
+#include "sky_link.h"
+#include "sky_worker.h"
+#include "moon_disc.h"
+#include "sky_atlas.h"
+#include "settings_store.h"
+#include "sky_clock.h"
+#include "profile.h"
 //
 // Watchface "ephemeris"
 //
@@ -10,250 +27,120 @@ static TextLayer *s_info_layer;
 
 // set up canvas layer for drawing
 static Layer *s_canvas_layer;
-// set up sun bitmaps
-static GBitmap *s_bitmap_sun;
-static GBitmap *s_bitmap_horizon;
-static GBitmap *s_bitmap_moon;
+// the sun and horizon sprites, views into one bitmap loaded at start
+static SkyAtlas s_atlas;
+// the moon is drawn from its phase, see moon_disc.h
+static MoonDisc s_moon_disc;
 
 // Global variables
-static float graph_width, graph_height;
+static SkyLayout s_layout;
 static int16_t solar_elev_x100[25];
 static int16_t lunar_elev_x100[25];
-static int lunar_offset_hour;
-static float lunar_fine_shift;
-static int lunar_day;
+// the tables above plus the lunar shift, set by redo_sky_paths()
+static SkyTables s_tables = { solar_elev_x100, lunar_elev_x100, 0, 0, 0 };
+// The points the paths are drawn through, refined where the tables facet
+static SkySamples s_solar_samples;
+static SkySamples s_lunar_samples;
+// Day, twilight and night behind the paths, one span per run of columns
+static SkyBands s_bands;
+// midnight the solar table starts at
+static time_t s_tables_midnight;
+// the next few days of tables, persisted so a launch need not compute them
+static SkyStoreCache s_stores;
+// the same days computed on the phone, which replace the watch's own
+static SkyLink s_link;
+// the background worker filling the next days, and how long to wait for it
+static SkyWorker s_worker;
+static AppTimer *s_worker_timer;
+static void worker_timer_callback(void *data);
 static int lunar_side = 0;
 static int info_offset = 0;
-static uint16_t lunar_image_id = 0xffff;
-static uint16_t solar_image_id = 0xffff;
+// the sun image the canvas shows, kept between updates for its hysteresis
+static bool s_sun_risen;
+static uint32_t s_sun_swaps;
 static time_t last_update_unixtime;
 static float last_update_latitude;
 static float last_update_longitude;
 static int last_lunar_side = 0;
+// redo_sky_paths() calls, those that found the tables current, and those
+// that had to compute the stored days
+static uint32_t s_sky_path_checks = 0;
+static uint32_t s_sky_path_avoided = 0;
+static uint32_t s_sky_store_fills = 0;
+
+// what the layers show, for redrawing only what changed
+static TextSlot s_time_text;
+static TextSlot s_date_text;
+static TextSlot s_info_text;
+static CanvasState s_canvas_shown;
+static uint32_t s_sky_version = 0;
+// paths and horizon, redrawn only when s_sky_version changes
+static SkyCache s_sky_cache;
+// the sprites only move every few minutes, so the canvas sleeps until the
+// next pixel change rather than refreshing every minute
+#define CANVAS_MAX_SLEEP_MINUTES 60
+static AppTimer *s_canvas_timer;
+static uint32_t s_canvas_wakeups = 0;
+
+// Settings messages come in bursts (Clay's, then the phone's location), so
+// they are applied as they arrive but acted on once, this long after the last
+#define CONFIG_SETTLE_MS 300
+static AppTimer *s_config_timer;
+static uint32_t s_config_messages = 0;
+static uint32_t s_config_passes = 0;
 
 // for debouncing
 static bool debounce;
 static AppTimer *debounce_timer;
 
-// Persistent storage key
+// Seconds the face's time moves per step of the Dayshift slider.  0 in
+// release builds, where the slider is hidden; build with
+// -DDAYSHIFT_STEP_SECS=3600 and unhide it in config.js to test other times.
+#ifndef DAYSHIFT_STEP_SECS
+#define DAYSHIFT_STEP_SECS 0
+#endif
+
+// Persistent storage keys
 #define SETTINGS_KEY 1
-// date/time constants and conversions
-#define PI 3.14159268
-#define DEG2RAD 0.017453293
-#define RAD2DEG 57.29577903
-// degrees to radians = pi / 180 and rad to deg = 180 / pi
-#define J2000 946684800
-// year 2000 in unix time
-#define MOONPERIOD_SEC 2551443
-#define MOONPERIOD_DAYS 29.530587981
-#define TILT_OF_EARTH 23.4397
-#define SECS_IN_DAY 86400
-// day in seconds = 24*60*60
-#define SECS_IN_HOUR 3600
-// hour in seconds = 60*60
-#define NO_AZI 0
-#define CALC_AZI 1
-#define NUM_INFO_ITEMS 4
-
-// Define our settings struct
-typedef struct ClaySettings {
-  float Latitude;
-  float Longitude;
-  bool ShowInfo;
-  time_t dayshift_secs;
-  int info_display;
-  int curr_solar_elev_int;
-  int curr_solar_azi_int;
-  int curr_lunar_elev_int;
-  int curr_lunar_azi_int;
-} ClaySettings;
-
-// An instance of the struct
+#define SKY_STORE_KEY 2  // and the SKY_STORE_SLOTS*SKY_STORE_KEYS - 1 keys after it
+// the worker's store (sky_worker.h) starts past the last of them
+_Static_assert(SKY_STORE_KEY + SKY_STORE_SLOTS*SKY_STORE_KEYS <= SKY_WORKER_STORE_KEY,
+               "sky store cache keys run into the worker's store");
+// a profiling build adds an item showing the profile, see profile.h
+#if defined(SKY_PROFILE)
+#define NUM_INFO_ITEMS 10
+#else
+#define NUM_INFO_ITEMS 9
+#endif
+
+// The configuration from the phone, see settings_store.h
 static ClaySettings settings;
-
-//
-// Adapted from the javascript code below to C
-//
-// https://github.com/mourner/suncalc/blob/master/suncalc.js
-//
-//
-// (c) 2011-2015, Vladimir Agafonkin
-// SunCalc is a JavaScript library for calculating sun/moon position and light phases.
-// https://github.com/mourner/suncalc
-//
-// sun calculations are based on http://aa.quae.nl/en/reken/zonpositie.html formulas
-
-
-float sin_pebble(float angle_radians) {
-  int32_t angle_pebble = angle_radians * TRIG_MAX_ANGLE / (2*PI);
-  return ((float)(sin_lookup(angle_pebble)) / (float)TRIG_MAX_RATIO);
-}
-
-float asin_pebble(float angle_radians) {
-  return (angle_radians);  // use small angle formula.
-}
-
-float cos_pebble(float angle_radians) {
-  int32_t angle_pebble = angle_radians * TRIG_MAX_ANGLE / (2*PI);
-  return ((float)cos_lookup(angle_pebble) / (float)TRIG_MAX_RATIO);
-}
-
-float atan2_pebble(float y, float x) {
-  if (x>2) APP_LOG(APP_LOG_LEVEL_DEBUG, "atan2: X too large, 100 x value = %d", (int)x);
-  if (y>2) APP_LOG(APP_LOG_LEVEL_DEBUG, "atan2: Y too large, 100 x value = %d", (int)y);
-  int16_t y_pebble = (int16_t) (8192 * y ); 
-  int16_t x_pebble = (int16_t) (8192 * x ); 
-  return (2*PI * (float)atan2_lookup(y_pebble, x_pebble) / (float)TRIG_MAX_ANGLE);
-}
-
-float fmod_pebble(float product, float divisor) {
-  int32_t factor;
-  float remainder;
-  
-  factor = (int32_t)(product/divisor);
-  if (product<0) factor--;    // casting to int truncates so check if negative and decrement
-  remainder = product - ((float)factor)*divisor;
-  return remainder;
-}
-
-float fabs_pebble(float input) {
-  float sign;
-  
-  if (input<0) sign = -1;
-  else sign = 1;
-    
-  return (sign*input);
-}
-
-int round_to_int(float input) {  
-  if (input>0)
-    return (int)(input+0.5);
-  else
-    return (int)(input-0.5);  
-}
-
-float toDays(time_t unixdate) {
-  return ((float)(unixdate-J2000) / SECS_IN_DAY -0.5);
-}
-
-// general calculations for position
-
-float e = DEG2RAD * TILT_OF_EARTH; 
-
-float rightAscension(float l, float b) {
-  return atan2_pebble(sin_pebble(l) * cos_pebble(e) - sin_pebble(b)/cos_pebble(b) * sin_pebble(e), cos_pebble(l));
-}
-
-float declination(float l, float b) { 
-  return (asin_pebble(sin_pebble(b) * cos_pebble(e) + cos_pebble(b) * sin_pebble(e) * sin_pebble(l)));
-}
-
-float azimuth(float H, float phi, float dec) {
-  return (atan2_pebble(sin_pebble(H), cos_pebble(H) * sin_pebble(phi) - sin_pebble(dec)/cos_pebble(dec) * cos_pebble(phi)));
-}
-
-float altitude(float H, float phi, float dec) { 
-  return (asin_pebble(sin_pebble(phi) * sin_pebble(dec) + cos_pebble(phi) * cos_pebble(dec) * cos_pebble(H))); 
-}
-
-float siderealTime(float d, float lw) { 
-  return (DEG2RAD * (280.16 + 360.9856235 * d) - lw);
-}
-
-// general sun calculations
-
-float solarMeanAnomaly(float d) { 
-  return (DEG2RAD * (357.5291 + 0.98560028 * d)); 
-}
-
-float eclipticLongitude(float M) {
-  float C = DEG2RAD * (1.9148 * sin_pebble(M) + 0.02 * sin_pebble(2 * M) + 0.0003 * sin_pebble(3 * M)); // equation of center
-  float P = DEG2RAD * 102.9372; // perihelion of the Earth
-  return (M + C + P + PI);
-}
-
-void sunCoords(float d, float *dec, float *ra) {
-
-  float M = solarMeanAnomaly(d);
-  float L = eclipticLongitude(M);
-
-  *dec = declination(L, 0);
-  *ra = rightAscension(L, 0);
-}
-
-void sunPosition(time_t unixdate, int calc_azi, float *azi, float *alt) {
-// calculates sun position for a given date and latitude/longitude
-
-  float lw  = DEG2RAD * -1*settings.Longitude;
-  float phi = DEG2RAD * settings.Latitude;
-  float d = toDays(unixdate);
-
-  float dec, ra;
-  sunCoords(d, &dec, &ra);
-  float H  = siderealTime(d, lw) - ra;
-
-  *alt = altitude(H, phi, dec) * RAD2DEG;
-  if (calc_azi == CALC_AZI)
-    *azi = fmod_pebble(((azimuth(H, phi, dec) + PI) * RAD2DEG ),360);
-};
-
-// moon calculations, based on http://aa.quae.nl/en/reken/hemelpositie.html formulas
-
-void moonCoords(float d, float *ra, float *dec) { 
-// geocentric ecliptic coordinates of the moon
-
-  float L = DEG2RAD * (218.316 + 13.176396 * d); // ecliptic longitude
-  float M = DEG2RAD * (134.963 + 13.064993 * d); // mean anomaly
-  float F = DEG2RAD * (93.272 + 13.229350 * d);  // mean distance
-
-  float l  = L + DEG2RAD * 6.289 * sin_pebble(M); // longitude
-  float b  = DEG2RAD * 5.128 * sin_pebble(F);     // latitude
-
-  *ra = rightAscension(l, b);
-  *dec = declination(l, b);
-}
-
-void moonPosition(time_t unixdate, int calc_azi, float *azi, float *alt) {
-  float lw  = DEG2RAD * -1*settings.Longitude;
-  float phi = DEG2RAD * settings.Latitude;
-  float d = toDays(unixdate);
-
-  float ra, dec;
-  moonCoords(d, &ra, &dec);
-  float H = siderealTime(d, lw) - ra;
-  float h = altitude(H, phi, dec);
-// formula 14.1 of "Astronomical Algorithms" 2nd edition by Jean Meeus (Willmann-Bell, Richmond) 1998.
-
-  *alt = h * RAD2DEG;
-  if (calc_azi == CALC_AZI)
-    *azi = fmod_pebble(((azimuth(H, phi, dec) + PI) * RAD2DEG ),360);
-};
-
-// Greatly simplified moon phase algorithm from
-// http://jivebay.com/calculating-the-moon-phase/
-// This simply takes a new moon and uses the moon cycle from there.
-// The function returns an integer between 0 and 29 that is the days
-// into the lunar cycle.  Thus, 0 is new moon, 15 is full moon, and 29 is new
-// note that in seconds, the lunar period, which is 29.5305882 earth days is
-// lunar period = 2551443 seconds
-
-float moonPhase(time_t unixdate) {
-  // 2016-Nov-29 12:19:25 UTC was a new moon
-  // 2016-Nov-29 12:19:25 UTC 1480421975 seconds (unix time)
-  // so mod the current unix timestamp minus this moon with the lunar period
-  // then convert to days by dividing by seconds in a day.
-  return ((float)((unixdate-1480421975)%MOONPERIOD_SEC)/(SECS_IN_DAY));
-
+static SettingsStore s_settings_store;
+// Observer derived from settings.Latitude/Longitude, see update_observer()
+static Observer s_observer;
+
+// Sun and moon positions for the current minute, see update_positions()
+static SkyPositions s_positions;
+// Rise, set, noon and twilight times for today, see todays_events()
+static SkyEvents s_events;
+
+// Refresh the cached observer, which only recomputes if the location moved
+static void update_observer() {
+  if (observer_set(&s_observer, settings.Latitude, settings.Longitude)) {
+    s_sky_version++;  // the graph scale follows the latitude
+    moon_disc_invalidate(&s_moon_disc);  // and the moon's tilt the location
+  }
+  if (sky_layout_set_latitude(&s_layout, settings.Latitude))
+    s_sky_version++;
 }
 
 void redo_sky_paths() {
-  int i;
-  float elev, azi;
   bool recalculate = false;
+  s_sky_path_checks++;
+  PROFILE_START(profile);
   
   // get today's date in local time  
-  time_t unixtime = time(NULL);
-  unixtime += settings.dayshift_secs;
+  time_t unixtime = sky_clock_shifted(NULL);
   struct tm *curr_time = localtime(&unixtime);
 
   // recalculate if old sky paths are more than an hour old or 0.5 degrees shifted location
@@ -278,6 +165,8 @@ void redo_sky_paths() {
   
   if (!recalculate) {
     APP_LOG(APP_LOG_LEVEL_DEBUG,"avoided recalculation");    
+    s_sky_path_avoided++;
+    PROFILE_STOP(profile, PROFILE_REDO_SKY_PATHS);
     return;
   }
 
@@ -289,10 +178,10 @@ void redo_sky_paths() {
   
   // calculate lunar shift
   APP_LOG(APP_LOG_LEVEL_DEBUG, "Solar %d, Lunar %d hours",(int)solar_display_hour, (int)lunar_display_hour);
-  lunar_fine_shift = -24*moonPhase(unixtime)*(SECS_IN_DAY)/((float)MOONPERIOD_SEC);
+  float lunar_fine_shift = -24*moonPhase(unixtime)*(SECS_IN_DAY)/((float)MOONPERIOD_SEC);
   if (lunar_fine_shift < -12)
       lunar_fine_shift += 24;  // condition to be in range -12 to +12 hours
-  float lunar_day_shift = 0;
+  int lunar_day_shift = 0;
   if ((lunar_fine_shift < 0) && (lunar_side == -1)) {// sun wrapped, go back a day for moon
     lunar_day_shift = -1;
     APP_LOG(APP_LOG_LEVEL_DEBUG, "Sun wrapped, going back a day for moon");
@@ -301,7 +190,7 @@ void redo_sky_paths() {
     lunar_day_shift = +1;
     APP_LOG(APP_LOG_LEVEL_DEBUG, "Moon wrapped, going forward a day for moon");
   } 
-  lunar_offset_hour = round_to_int(lunar_fine_shift);
+  int lunar_offset_hour = round_to_int(lunar_fine_shift);
   lunar_fine_shift = lunar_fine_shift - (float)lunar_offset_hour;
   APP_LOG(APP_LOG_LEVEL_DEBUG, "Lunar offset hour %d",lunar_offset_hour);
   APP_LOG(APP_LOG_LEVEL_DEBUG, "  Lunar fine shift x100 = %d",(int)(lunar_fine_shift*100));
@@ -312,97 +201,128 @@ void redo_sky_paths() {
   curr_time->tm_hour = 0;
   unixtime = mktime(curr_time);
 
-  // cycle through 25 hours for solar and lunar parameters
-  i = 0;
-//  APP_LOG(APP_LOG_LEVEL_DEBUG,"lat,lon [%d:%d]", (int)settings.Latitude, (int)settings.Longitude);
-  do {
-    // Solar calculation
-    sunPosition(unixtime, NO_AZI, &azi, &elev);
-    solar_elev_x100[i] = (int16_t)(100*elev);
-//    APP_LOG(APP_LOG_LEVEL_DEBUG, "hour %d Solar: Elev %d", i, (int)elev);
-    // Lunar calculation
-    moonPosition(unixtime+(time_t)(-SECS_IN_HOUR*lunar_offset_hour + 86400*lunar_day_shift), NO_AZI, NULL, &elev);
-    lunar_elev_x100[i] = (int16_t)(100*elev);
-//    APP_LOG(APP_LOG_LEVEL_DEBUG, "  Hr %d  Lunar: Elev %d", i, (int)elev);
-
-    unixtime += SECS_IN_HOUR;     // advance to the next hour and next point
-    i++;
+  // 25 hours of solar and lunar parameters, from the stored days of this
+  // location if they cover them
+  time_t lunar_start = unixtime+(time_t)(-SECS_IN_HOUR*lunar_offset_hour + SECS_IN_DAY*lunar_day_shift);
+  SkyStore *store = sky_store_cache_find(&s_stores, &s_observer, unixtime, lunar_start);
+  if (!store && s_tables_midnight && sky_worker_request(&s_worker, &s_observer)) {
+    // the worker fills them; the old tables stay up until it answers.  A
+    // cold start has none up and fills them here, see sky_worker.h
+    if (!s_worker_timer)
+      s_worker_timer = app_timer_register(SKY_WORKER_TIMEOUT_MS, worker_timer_callback, NULL);
+    last_update_unixtime = 0;  // look again on the next pass
+    PROFILE_STOP(profile, PROFILE_REDO_SKY_PATHS);
+    return;
   }
-  while (i<25);
-  APP_LOG(APP_LOG_LEVEL_DEBUG, "Re-calculated sky paths");
+  bool filled = !store;
+  if (filled)
+    store = sky_store_cache_get(&s_stores, &s_observer, unixtime, lunar_start, &filled);
+  s_tables.lunar_offset_hour = lunar_offset_hour;
+  s_tables.lunar_day_shift = lunar_day_shift;
+  s_tables.lunar_fine_shift_min = round_to_int(lunar_fine_shift*60);
+  s_tables_midnight = unixtime;
+  sky_store_table(store, &s_observer, SKY_BODY_SUN, unixtime, solar_elev_x100);
+  sky_store_table(store, &s_observer, SKY_BODY_MOON, lunar_start, lunar_elev_x100);
+  if (filled) {
+    // new location or past the stored days: computed the next few days
+    s_sky_store_fills++;
+    sky_store_cache_save(&s_stores, store, SKY_STORE_KEY);
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "Re-calculated sky paths for %d days", SKY_STORE_DAYS);
+    // the phone's are more precise, ask for them to replace these
+    sky_link_request(&s_link, &s_observer, unixtime, sky_clock_now());
+  }
+  else if (unixtime - store->start >= (SKY_STORE_DAYS-1)*SECS_IN_DAY - SECS_IN_HOUR) {
+    // on the last stored day, have the phone send the next days before they run out
+    sky_link_request(&s_link, &s_observer, unixtime, sky_clock_now());
+  }
+  // only computed again when the day or the location moves
+  sky_samples_update(&s_solar_samples, SKY_BODY_SUN, &s_observer, unixtime);
+  sky_samples_update(&s_lunar_samples, SKY_BODY_MOON, &s_observer, lunar_start);
+  sky_bands_build(&s_bands, &s_layout, solar_elev_x100);
+  s_sky_version++;
+  PROFILE_STOP(profile, PROFILE_REDO_SKY_PATHS);
 }
 
-static void load_moon_image() {
-  // Get a tm structure
-  time_t unixtime = time(NULL);
-  unixtime += settings.dayshift_secs;
-  uint16_t curr_image_id;
-
-  // get lunar day and load new image
-  lunar_day = (int)moonPhase(unixtime);  // truncate (do not round) the result
-
-  if (lunar_day < 3)
-    curr_image_id = RESOURCE_ID_IMAGE_MOON1;
-  if ((lunar_day < 6) && (lunar_day >= 3)) 
-    curr_image_id = RESOURCE_ID_IMAGE_MOON2;
-  if ((lunar_day < 10) && (lunar_day >= 6))  // first quarter moon -- 4 days
-    curr_image_id = RESOURCE_ID_IMAGE_MOON3;
-  if ((lunar_day < 13) && (lunar_day >= 10)) 
-    curr_image_id = RESOURCE_ID_IMAGE_MOON4;
-  if ((lunar_day < 16) && (lunar_day >= 13)) 
-    curr_image_id = RESOURCE_ID_IMAGE_MOON5;
-  if ((lunar_day < 19) && (lunar_day >= 16)) 
-    curr_image_id = RESOURCE_ID_IMAGE_MOON6;
-  if ((lunar_day < 23) && (lunar_day >= 19)) // third quarter moon -- 4 days
-    curr_image_id = RESOURCE_ID_IMAGE_MOON7;
-  if ((lunar_day < 26) && (lunar_day >= 23)) 
-    curr_image_id = RESOURCE_ID_IMAGE_MOON8;
-  if (lunar_day >= 26) 
-    curr_image_id = RESOURCE_ID_IMAGE_MOON9;
-  
-  if (curr_image_id != lunar_image_id) {
-    if (s_bitmap_moon != NULL) {
-      // destroy old moon image  
-      gbitmap_destroy(s_bitmap_moon);
-//      APP_LOG(APP_LOG_LEVEL_DEBUG, "Deleted old lunar image");
-    }
-    lunar_image_id = curr_image_id;
-    s_bitmap_moon = gbitmap_create_with_resource(lunar_image_id);
-//    APP_LOG(APP_LOG_LEVEL_DEBUG, "Selected moon image for lunar day (moon phase 0-29) %d", lunar_day);
-  }  
+// The info line needs the sun or moon numbers, including azimuth
+static bool precise_positions_needed() {
+  int item = (settings.info_display + info_offset) % NUM_INFO_ITEMS;
+  return settings.ShowInfo && ((item == 0) || (item == 1));
 }
 
-static void load_sun_image() {
-  uint16_t curr_image_id;
+// Bring s_positions up to the current minute.  Called from the tick and
+// event handlers so that rendering only ever reads the cache.  When the
+// info line does not show positions, elevations come from the hourly tables.
+static void update_positions() {
+  time_t unixtime = sky_clock_shifted(NULL);
+  struct tm *curr_time = localtime(&unixtime);
 
-  // select and solar image
-  if (settings.curr_solar_elev_int <= 0)
-    curr_image_id = RESOURCE_ID_IMAGE_SUN_RIM;
-  else 
-    curr_image_id = RESOURCE_ID_IMAGE_SUN_RISEN;
-  
-  if (curr_image_id != solar_image_id) {
-    if (s_bitmap_sun != NULL) {
-      // destroy old moon image  
-      gbitmap_destroy(s_bitmap_sun);
-//      APP_LOG(APP_LOG_LEVEL_DEBUG, "Deleted old solar image");
-    }
-    solar_image_id = curr_image_id;
-    s_bitmap_sun = gbitmap_create_with_resource(solar_image_id);
-//    APP_LOG(APP_LOG_LEVEL_DEBUG, "Selected new solar image");
-  }  
+  // the lunar table is shifted by lunar_offset_hour and maybe a day
+  int lunar_index = sky_tables_lunar_index(&s_tables, curr_time->tm_hour);
+  bool precise = precise_positions_needed() || (lunar_index < 0);
+  if (position_cache_hit(&s_positions, &s_observer, unixtime, precise))
+    return;
+  PROFILE_START(profile);
+
+  if (precise) {
+    position_cache_compute(&s_positions, &s_observer, unixtime);
+  }
+  else {
+    position_cache_from_tables(&s_positions, &s_observer, unixtime,
+                               sky_path_elev_at(solar_elev_x100, curr_time->tm_hour, curr_time->tm_min),
+                               sky_path_elev_at(lunar_elev_x100, lunar_index, curr_time->tm_min));
+  }
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Sun [%d:%d]", round_to_int(s_positions.solar_elev), round_to_int(s_positions.solar_azi));
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Moon [%d:%d]", round_to_int(s_positions.lunar_elev), round_to_int(s_positions.lunar_azi));
+  PROFILE_STOP(profile, PROFILE_UPDATE_POSITIONS);
+}
+
+// Today's events, only solved again when the day or location changes
+static const SkyEvents *todays_events(time_t unixtime) {
+  struct tm day = *localtime(&unixtime);
+  day.tm_hour = 0;
+  day.tm_min = 0;
+  day.tm_sec = 0;
+  sky_events_update(&s_events, &s_observer, mktime(&day), solar_elev_x100, s_tables_midnight);
+  return &s_events;
+}
+
+// "6:12" in the watch's clock style, or "--:--" if the event does not happen
+static void format_event_time(char *buffer, size_t size, time_t event) {
+  if (event == SKY_EVENT_NONE) {
+    snprintf(buffer, size, "--:--");
+    return;
+  }
+  struct tm *event_time = localtime(&event);
+  int hour = event_time->tm_hour;
+  if (!clock_is_24h_style()) {
+    hour = hour % 12;
+    if (hour == 0) hour = 12;
+  }
+  snprintf(buffer, size, "%d:%02d", hour, event_time->tm_min);
+}
+
+// "Sun 6:12-18:40", falling back to the short label when that is too long
+static void format_event_pair(char *buffer, size_t size, const char *label, const char *short_label,
+                              time_t first, time_t second) {
+  char first_text[6], second_text[6];
+  format_event_time(first_text, sizeof(first_text), first);
+  format_event_time(second_text, sizeof(second_text), second);
+  if (snprintf(buffer, size, "%s%s-%s", label, first_text, second_text) >= (int)size)
+    snprintf(buffer, size, "%s%s-%s", short_label, first_text, second_text);
 }
 
 static void update_time() {
+  PROFILE_START(profile);
   // Get a tm structure
-  time_t unixtime = time(NULL);
-  unixtime += settings.dayshift_secs;
+  time_t unixtime = sky_clock_shifted(NULL);
   struct tm *tick_time = localtime(&unixtime);
 
   // Write the current hours and minutes into a buffer
   static char s_buffer[8];
   static char s_date_buffer[12];
-  static char s_info_buffer[15];
+  static char s_info_buffer[TEXT_SLOT_SIZE];
+  const SkyEvents *events;
+  char event_text[6];
   
   strftime(s_buffer, sizeof(s_buffer), clock_is_24h_style() ?
                                           "%k:%M" : "%l:%M", tick_time);
@@ -410,92 +330,187 @@ static void update_time() {
 //                                          "%H:%M" : "%I:%M", tick_time);
   if (s_buffer[0] == ' ') {
     // cut the leading space
-    text_layer_set_text(s_time_layer, &(s_buffer[1]));
+    text_slot_set(&s_time_text, &(s_buffer[1]));
   }
   else {
-    text_layer_set_text(s_time_layer, s_buffer);
+    text_slot_set(&s_time_text, s_buffer);
   }
   // Display this time on the TextLayer
   
   // Update the date text  
   strftime(s_date_buffer, sizeof(s_date_buffer), "%a, %b %e", tick_time);
-  text_layer_set_text(s_date_layer, s_date_buffer);
+  text_slot_set(&s_date_text, s_date_buffer);
   
   // Update the info text -- if we want to show information
   if (settings.ShowInfo) {
     switch ((settings.info_display + info_offset) % NUM_INFO_ITEMS) {
       case 0:
         snprintf(s_info_buffer, sizeof(s_info_buffer), PBL_IF_ROUND_ELSE("S [%d:%d]","Sun [%d:%d]"), 
-                   settings.curr_solar_elev_int, settings.curr_solar_azi_int);
-        text_layer_set_text(s_info_layer, s_info_buffer);
+                   round_to_int(s_positions.solar_elev), round_to_int(s_positions.solar_azi));
+        text_slot_set(&s_info_text, s_info_buffer);
       break;
       case 1:
         snprintf(s_info_buffer, sizeof(s_info_buffer), PBL_IF_ROUND_ELSE("M [%d:%d]","Moon [%d:%d]"),
-                 settings.curr_lunar_elev_int, settings.curr_lunar_azi_int);
-        text_layer_set_text(s_info_layer, s_info_buffer);
+                 round_to_int(s_positions.lunar_elev), round_to_int(s_positions.lunar_azi));
+        text_slot_set(&s_info_text, s_info_buffer);
         break;
       case 2:
         snprintf(s_info_buffer, sizeof(s_info_buffer), PBL_IF_ROUND_ELSE("Moon %dd","Moon %dd old"),
                    (int)moonPhase(unixtime));
-        text_layer_set_text(s_info_layer, s_info_buffer);
+        text_slot_set(&s_info_text, s_info_buffer);
         break;
       case 3:
         snprintf(s_info_buffer, sizeof(s_info_buffer), PBL_IF_ROUND_ELSE("L:%+d,%+d","Loc:%+d,%+d"),
                 round_to_int(settings.Latitude), round_to_int(settings.Longitude));
-        text_layer_set_text(s_info_layer, s_info_buffer);
+        text_slot_set(&s_info_text, s_info_buffer);
         break;  
+      case 4:
+        events = todays_events(unixtime);
+        format_event_pair(s_info_buffer, sizeof(s_info_buffer), PBL_IF_ROUND_ELSE("S ","Sun "), "S ",
+                          events->time[SKY_EVENT_SUNRISE], events->time[SKY_EVENT_SUNSET]);
+        text_slot_set(&s_info_text, s_info_buffer);
+        break;
+      case 5:
+        events = todays_events(unixtime);
+        format_event_pair(s_info_buffer, sizeof(s_info_buffer), PBL_IF_ROUND_ELSE("M ","Moon "), "M ",
+                          events->time[SKY_EVENT_MOONRISE], events->time[SKY_EVENT_MOONSET]);
+        text_slot_set(&s_info_text, s_info_buffer);
+        break;
+      case 6:
+        events = todays_events(unixtime);
+        format_event_time(event_text, sizeof(event_text), events->time[SKY_EVENT_SOLAR_NOON]);
+        snprintf(s_info_buffer, sizeof(s_info_buffer), "Noon %s", event_text);
+        text_slot_set(&s_info_text, s_info_buffer);
+        break;
+      case 7:
+        events = todays_events(unixtime);
+        format_event_pair(s_info_buffer, sizeof(s_info_buffer), PBL_IF_ROUND_ELSE("C ","Civ "), "C ",
+                          events->time[SKY_EVENT_CIVIL_DAWN], events->time[SKY_EVENT_CIVIL_DUSK]);
+        text_slot_set(&s_info_text, s_info_buffer);
+        break;
+      case 8:
+        events = todays_events(unixtime);
+        format_event_pair(s_info_buffer, sizeof(s_info_buffer), PBL_IF_ROUND_ELSE("N ","Nau "), "N ",
+                          events->time[SKY_EVENT_NAUTICAL_DAWN], events->time[SKY_EVENT_NAUTICAL_DUSK]);
+        text_slot_set(&s_info_text, s_info_buffer);
+        break;
+#if defined(SKY_PROFILE)
+      case 9:
+        // a different function each minute
+        profile_format((ProfileSection)(tick_time->tm_min % PROFILE_SECTIONS),
+                       s_info_buffer, sizeof(s_info_buffer));
+        text_slot_set(&s_info_text, s_info_buffer);
+        break;
+#endif
     }
   }
   else {
     snprintf(s_info_buffer, sizeof(s_info_buffer), " ");
-    text_layer_set_text(s_info_layer, s_info_buffer);
+    text_slot_set(&s_info_text, s_info_buffer);
   }
   APP_LOG(APP_LOG_LEVEL_DEBUG, "Updated screen");
+  PROFILE_STOP(profile, PROFILE_UPDATE_TIME);
 }
 
-static void tick_handler(struct tm *tick_time, TimeUnits units_changed) {
-  update_time();
+// Work out what the canvas will draw at this minute, and only mark it dirty
+// if that differs from what it drew last.  Sprites follow the hourly tables,
+// so sky_layout_minutes_to_move() can tell when they will next change.
+static void update_canvas() {
+  CanvasState next;
+  SkySprites sprites;
+  PROFILE_START(profile);
+
+  time_t curr_unixtime = sky_clock_shifted(NULL);
+  struct tm *curr_time = localtime(&curr_unixtime);
+
+  sky_layout_sprites(&s_layout, &s_tables, curr_time->tm_hour, curr_time->tm_min,
+                     s_positions.lunar_elev, s_sun_risen, &sprites);
+  if (sprites.sun_risen != s_sun_risen) s_sun_swaps++;
+  s_sun_risen = sprites.sun_risen;
+  // bring the moon's phase up to date
+  moon_disc_update(&s_moon_disc, &s_observer, curr_unixtime);
+
+  next.sky_version = s_sky_version;
+  next.sun_image = s_sun_risen ? SKY_SPRITE_SUN_RISEN : SKY_SPRITE_SUN_RIM;
+  next.moon_disc = s_moon_disc.version;
+  next.sun = sprites.sun;
+  next.moon = sprites.moon;
+  canvas_state_update(&s_canvas_shown, &next, s_canvas_layer);
+  PROFILE_STOP(profile, PROFILE_UPDATE_CANVAS);
 }
 
-int hour_to_xpixel (float hour) {
-  // width = 0 to 24 hours
-  return (int)(hour/24 * graph_width);
+static void canvas_timer_callback(void *data);
+
+// Sleep the canvas until the minute a sprite next moves
+static void schedule_canvas_update() {
+  uint16_t ms;
+  time_t unixtime = sky_clock_shifted(&ms);
+  struct tm *curr_time = localtime(&unixtime);
+
+  int minutes = sky_layout_minutes_to_move(&s_layout, &s_tables, curr_time->tm_hour, curr_time->tm_min,
+                                           s_positions.lunar_elev, s_sun_risen, CANVAS_MAX_SLEEP_MINUTES);
+  // wake just after that minute turns
+  uint32_t delay_ms = (uint32_t)(minutes*60 - curr_time->tm_sec)*1000 - ms + 100;
+  if (!s_canvas_timer || !app_timer_reschedule(s_canvas_timer, delay_ms))
+    s_canvas_timer = app_timer_register(delay_ms, canvas_timer_callback, NULL);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Canvas sleeps %d min", minutes);
 }
 
-float interp_elev(float curr_elev, float next_elev, float frac_hour) {
-  return(curr_elev + (next_elev-curr_elev)*frac_hour);
+static void canvas_timer_callback(void *data) {
+  s_canvas_timer = NULL;
+  s_canvas_wakeups++;
+  // tables go stale after an hour, and the timer never sleeps longer
+  redo_sky_paths();
+  update_positions();
+  update_canvas();
+  schedule_canvas_update();
 }
 
-float interp_azi(float curr_azi, float next_azi, float frac_hour) {
-  float slope;
-  slope = next_azi - curr_azi;
-  if (slope<0) slope +=360;  // handle "wrap around situation"
-  return(fmod_pebble(curr_azi + slope*frac_hour,360));  
+// New stored days came in: take their tables now, and everything drawn
+// from them.  The path samples are the watch's own and stay.
+static void refresh_sky_tables() {
+  last_update_unixtime = 0;
+  redo_sky_paths();
+  position_cache_invalidate(&s_positions);
+  update_positions();
+  update_canvas();
+  schedule_canvas_update();
 }
 
-float interp_hour (int hour, float frac_hour, float offset) {
-  return (fmod_pebble(((float)hour + frac_hour + offset),24));
+// The worker asks where the watch is when it starts, and says when it has
+// saved a store
+static void worker_message_handler(uint16_t type, AppWorkerMessage *message) {
+  if (type == SKY_WORKER_MSG_STARTED) {
+    sky_worker_place(&s_observer);
+  }
+  else if (type == SKY_WORKER_MSG_READY) {
+    bool waiting = s_worker.pending;
+    SkyStore *store = sky_worker_receive(&s_worker, &s_stores);
+    if (store)
+      sky_store_cache_save(&s_stores, store, SKY_STORE_KEY);
+    bool answered = waiting && !s_worker.pending;
+    if (!answered)
+      return;  // the worker's own refill; the next redo finds it
+    if (s_worker_timer) {
+      app_timer_cancel(s_worker_timer);
+      s_worker_timer = NULL;
+    }
+    refresh_sky_tables();
+  }
 }
 
-int angle_to_ypixel (float angle) {
-  // set y scale based upon latitude
-  int range = (90 - fabs_pebble(settings.Latitude) + TILT_OF_EARTH) * 1.35;  // full graph 135% of the potential range at that lat
-  if (range>110) range = 110;
-  int top = (90 - fabs_pebble(settings.Latitude) + TILT_OF_EARTH) * 1.05;  // this gives a 30% buffer below the horizon.
-  if (top>90) top = 90;
-  return (int)(((top-angle)*graph_height)/range);
+// No store from the worker in time: the face fills the tables itself
+static void worker_timer_callback(void *data) {
+  s_worker_timer = NULL;
+  sky_worker_timeout(&s_worker);
+  refresh_sky_tables();
 }
 
-static void canvas_update_proc(Layer *layer, GContext *ctx) {
-  // Custom drawing happens here!
+// The static sky: solar and lunar paths plus the horizon
+static void draw_sky_background(GContext *ctx) {
   int i;
   GPoint point1, point2;
-  float curr_elev, curr_azi, next_elev, curr_azi_hour, next_azi_hour;
-  
-  // Get the time and a tm structure
-  time_t curr_unixtime = time(NULL);
-  curr_unixtime += settings.dayshift_secs;
-  struct tm *curr_time = localtime(&curr_unixtime);
+  int curr_minute, next_minute;
 
   // Set the line color
   graphics_context_set_stroke_color(ctx, GColorWhite);
@@ -505,68 +520,59 @@ static void canvas_update_proc(Layer *layer, GContext *ctx) {
   graphics_context_set_fill_color(ctx, GColorWhite);
   // Set the compositing mode (GCompOpSet is required for transparency)
   graphics_context_set_compositing_mode(ctx, GCompOpSet);
+
+  // Shade the sky behind everything else
+  sky_bands_draw(&s_bands, ctx, &s_layout);
   
   // Draw solar path
-  for (i=0;i<24;i++) {
-    point1 = GPoint(hour_to_xpixel(i),angle_to_ypixel((float)(solar_elev_x100[i]/100)));
-    point2 = GPoint(hour_to_xpixel(i+1),angle_to_ypixel((float)(solar_elev_x100[i+1]/100)));
-    if ((solar_elev_x100[i]>0)||(solar_elev_x100[i+1]>0) ) graphics_draw_line(ctx, point1, point2);
+  const int16_t *sun = s_solar_samples.elev_x100;
+  for (i=0;i+1<SKY_SAMPLES_COUNT;i++) {
+    point1 = sky_layout_point(&s_layout,SKY_SAMPLES_MINUTE(i),sun[i]);
+    point2 = sky_layout_point(&s_layout,SKY_SAMPLES_MINUTE(i+1),sun[i+1]);
+    if ((sun[i]>0)||(sun[i+1]>0) ) graphics_draw_line(ctx, point1, point2);
   }
-  // Draw lunar path (dashed line)
-  for (i=0;i<24;i++) {
-    curr_azi_hour = interp_hour(i,0,lunar_fine_shift);
-    next_azi_hour = interp_hour(i,0.5,lunar_fine_shift);
-    if (next_azi_hour > curr_azi_hour) {            // check to prevent "wrap around"
-      next_elev = interp_elev((float)(lunar_elev_x100[i]/100),(float)(lunar_elev_x100[i+1]/100),0.5);
-      point1 = GPoint(hour_to_xpixel(curr_azi_hour),angle_to_ypixel((float)(lunar_elev_x100[i]/100)));
-      point2 = GPoint(hour_to_xpixel(next_azi_hour),angle_to_ypixel(next_elev));
-      if ((lunar_elev_x100[i]>0)||(lunar_elev_x100[i+1]>0)) graphics_draw_line(ctx, point1, point2);      
+  // Draw lunar path (dashed line), each dash the first half of an hour
+  const int16_t *moon = s_lunar_samples.elev_x100;
+  for (i=0;i+1<SKY_SAMPLES_COUNT;i++) {
+    if (i % SKY_SAMPLES_PER_HOUR >= SKY_SAMPLES_PER_HOUR/2)
+      continue;
+    curr_minute = (SKY_SAMPLES_MINUTE(i)+s_tables.lunar_fine_shift_min+24*60)%(24*60);
+    next_minute = (SKY_SAMPLES_MINUTE(i+1)+s_tables.lunar_fine_shift_min+24*60)%(24*60);
+    // check to prevent "wrap around"; the dial has no edge to wrap across
+    if ((next_minute > curr_minute) || s_layout.polar) {
+      point1 = sky_layout_point(&s_layout,curr_minute,moon[i]);
+      point2 = sky_layout_point(&s_layout,next_minute,moon[i+1]);
+      if ((moon[i]>0)||(moon[i+1]>0)) graphics_draw_line(ctx, point1, point2);
     }
   }
   
-  // Generate the horizon 
-  GRect horizon_box = GRect(hour_to_xpixel(0),angle_to_ypixel(0),hour_to_xpixel(24),28);
-  // Draw the horizon box
-  graphics_draw_bitmap_in_rect(ctx, s_bitmap_horizon, horizon_box);
-
-  // Calculate sun position
-  int hour = curr_time->tm_hour;  
-  float frac_hour = ((float)curr_time->tm_min)/60;
-  // calculate and store solar position
-  sunPosition(curr_unixtime, CALC_AZI, &curr_azi, &curr_elev);
-  settings.curr_solar_elev_int = round_to_int(curr_elev);
-  settings.curr_solar_azi_int = round_to_int(curr_azi);
-  APP_LOG(APP_LOG_LEVEL_DEBUG, "Sun [%d:%d]", settings.curr_solar_elev_int, settings.curr_solar_azi_int);
-  // having calculated the solar elevation, load a sun image (maybe a new one)
-  load_sun_image();  
-  // calculate the display azimuth hour
-  curr_azi_hour = interp_hour(hour,frac_hour,0);
-  // If sun is too low, stop lowering its position
-  if (curr_elev < -7) curr_elev = -7;
-  // Get the location to place the sun
-  GRect bitmap_placed = GRect(hour_to_xpixel(curr_azi_hour)-7,angle_to_ypixel(curr_elev)-6,15,13);
-  // Draw the image
-  graphics_draw_bitmap_in_rect(ctx, s_bitmap_sun, bitmap_placed);
-
-  // Now calculate moon position
-  int lunar_hour = (hour + lunar_offset_hour) % 24;
-  if (lunar_hour<0) lunar_hour = lunar_hour + 24;
-  APP_LOG(APP_LOG_LEVEL_DEBUG, "Moon Hour %d", lunar_hour);
-  // calculate and store lunar position
-  moonPosition(curr_unixtime, CALC_AZI, &curr_azi, &curr_elev);
-  settings.curr_lunar_elev_int = round_to_int(curr_elev);
-  settings.curr_lunar_azi_int = round_to_int(curr_azi);
-  APP_LOG(APP_LOG_LEVEL_DEBUG, "Moon [%d:%d]", settings.curr_lunar_elev_int, settings.curr_lunar_azi_int);
-  // load a moon image (maybe a new one)
-  load_moon_image();
-  // calculate the lunar azimith hour for display
-  curr_azi_hour = interp_hour(lunar_hour,frac_hour,lunar_fine_shift);
-  // If moon is too low, stop lowering its position
-  if (curr_elev < -7) curr_elev = -7;
-  // Get the location to place the moon
-  GRect bitmap_moon_placed = GRect(hour_to_xpixel(curr_azi_hour)-6,angle_to_ypixel(curr_elev)-6,13,13);
-  // Draw the image
-  graphics_draw_bitmap_in_rect(ctx, s_bitmap_moon, bitmap_moon_placed);
+  // Draw the horizon: a ring on the dial, the horizon box across the rectangle
+  if (s_layout.polar) {
+    graphics_draw_circle(ctx, s_layout.center, sky_layout_depth(&s_layout, 0));
+  }
+  else {
+    GRect horizon_box = GRect(0,sky_layout_depth(&s_layout, 0),s_layout.graph_width,28);
+    graphics_draw_bitmap_in_rect(ctx, sky_atlas_sprite(&s_atlas, SKY_SPRITE_HORIZON), horizon_box);
+  }
+}
+
+static void canvas_update_proc(Layer *layer, GContext *ctx) {
+  PROFILE_START(profile);
+  // Custom drawing happens here!
+  sky_cache_draw(&s_sky_cache, ctx, layer_get_bounds(layer), s_sky_version, draw_sky_background);
+
+  // Draw the sun and moon where update_canvas() placed them
+  graphics_context_set_compositing_mode(ctx, GCompOpSet);
+  graphics_draw_bitmap_in_rect(ctx, sky_atlas_sprite(&s_atlas, s_canvas_shown.sun_image),
+                               s_canvas_shown.sun);
+  moon_disc_draw(&s_moon_disc, ctx, s_canvas_shown.moon.origin);
+  PROFILE_STOP(profile, PROFILE_CANVAS_DRAW);
+}
+
+// The minute tick only keeps the text current, the canvas has its own timer
+static void tick_handler(struct tm *tick_time, TimeUnits units_changed) {
+  update_positions();
+  update_time();
 }
 
 // code to get settings from phone via pebble-clay
@@ -577,33 +583,110 @@ static void prv_default_settings() {
   settings.Longitude = -147;
   settings.ShowInfo = true;
   settings.info_display = 0;
+  settings.BackgroundWorker = false;
+  settings.worker_asked = false;
 }
 
-// Save the settings to persistent storage
+// Save the settings to persistent storage, if they changed.  The info
+// item shown is stored as the one to start with next time.
 static void prv_save_settings() {
-  settings.info_display = (settings.info_display + info_offset) % NUM_INFO_ITEMS;
-  persist_write_data(SETTINGS_KEY, &settings, sizeof(settings));
+  ClaySettings stored = settings;
+  stored.info_display = (settings.info_display + info_offset) % NUM_INFO_ITEMS;
+  settings_store_save(&s_settings_store, SETTINGS_KEY, &stored);
 }
 
 static void prv_load_settings() {
   // Load the default settings
   prv_default_settings();
   // Read settings from persistent storage, if they exist
-  persist_read_data(SETTINGS_KEY, &settings, sizeof(settings));
+  settings_store_load(&s_settings_store, SETTINGS_KEY, &settings);
+  settings.info_display %= NUM_INFO_ITEMS;
+  sky_clock_set_shift(settings.dayshift_secs);
+  update_observer();
+  // stored sky paths of the last few locations, and any the worker filled
+  // while the face was away
+  sky_store_cache_load(&s_stores, SKY_STORE_KEY);
+  SkyStore *store = sky_worker_receive(&s_worker, &s_stores);
+  if (store)
+    sky_store_cache_save(&s_stores, store, SKY_STORE_KEY);
+}
+
+// The worker is opt in: the watch runs one background worker at a time,
+// and launching ours over another app's asks the user first.  A launch
+// that asked and did not leave ours running by the next start of the face
+// was declined, which turns the setting off until the user sets it again;
+// the face fills its own tables meanwhile.
+static void apply_worker_setting(bool at_start) {
+  if (!settings.BackgroundWorker) {
+    settings.worker_asked = false;
+    if (app_worker_is_running())
+      app_worker_kill();
+    return;
+  }
+  if (app_worker_is_running()) {
+    settings.worker_asked = false;
+    return;
+  }
+  if (settings.worker_asked) {
+    // still waiting on the user, unless the face has started since
+    if (at_start) {
+      APP_LOG(APP_LOG_LEVEL_DEBUG, "Background worker declined");
+      settings.BackgroundWorker = false;
+      settings.worker_asked = false;
+    }
+    return;
+  }
+  settings.worker_asked = (app_worker_launch() == APP_WORKER_RESULT_ASKING_CONFIRMATION);
+}
+
+// One pass over everything the settings feed: location, tables, positions,
+// canvas and text, then the save
+static void config_timer_callback(void *data) {
+  s_config_timer = NULL;
+  s_config_passes++;
+  sky_clock_set_shift(settings.dayshift_secs);
+  update_observer();
+  apply_worker_setting(false);
+  redo_sky_paths();
+  // tables or location may have changed within the minute
+  position_cache_invalidate(&s_positions);
+  update_positions();
+  update_canvas();
+  schedule_canvas_update();
+  // redraw watchface
+  update_time();
+  // save settings
+  prv_save_settings();
 }
 
 static void prv_inbox_received_handler(DictionaryIterator *iter, void *context) {
+  // sky path rows from the phone, not settings
+  if (dict_find(iter, MESSAGE_KEY_SkyRequest)) {
+    if (sky_link_receive(&s_link, iter)) {
+      sky_store_cache_save(&s_stores, sky_store_cache_put(&s_stores, &s_link.store), SKY_STORE_KEY);
+      refresh_sky_tables();
+    }
+    return;
+  }
+
   // Read lat / lon and other
   Tuple *latitude_t = dict_find(iter, MESSAGE_KEY_Latitude);
   if(latitude_t) {
     settings.Latitude = (float)(latitude_t->value->int32);
-    redo_sky_paths();
   }
 
   Tuple *longitude_t = dict_find(iter, MESSAGE_KEY_Longitude);
   if(longitude_t) {
     settings.Longitude = (float)(longitude_t->value->int32);
-    redo_sky_paths();
+  }
+
+  // The phone's own position, in hundredths of a degree, sent by index.js
+  // only when it has moved far enough to matter
+  Tuple *phone_latitude_t = dict_find(iter, MESSAGE_KEY_PhoneLatitude);
+  Tuple *phone_longitude_t = dict_find(iter, MESSAGE_KEY_PhoneLongitude);
+  if(phone_latitude_t && phone_longitude_t) {
+    settings.Latitude = phone_latitude_t->value->int32 / 100.0f;
+    settings.Longitude = phone_longitude_t->value->int32 / 100.0f;
   }
 
   // Read boolean preferences
@@ -612,18 +695,24 @@ static void prv_inbox_received_handler(DictionaryIterator *iter, void *context)
     settings.ShowInfo = show_info_t->value->int32 == 1;
   }
 
+  // setting it, on or off, is a fresh answer to the worker's launch
+  Tuple *worker_t = dict_find(iter, MESSAGE_KEY_BackgroundWorker);
+  if(worker_t) {
+    settings.BackgroundWorker = worker_t->value->int32 == 1;
+    settings.worker_asked = false;
+  }
+
   // The "Dayshift" variable is normally not used, but can be used to test 
-  // the behvaior at other times.  In normal operations, the multiplier of the
-  // slider variable is set to 0 and then the slider is hidden.
+  // the behvaior at other times.  In normal operations DAYSHIFT_STEP_SECS
+  // is 0 and the slider is hidden.
   Tuple *dayshift_t = dict_find(iter, MESSAGE_KEY_Dayshift);
   if(dayshift_t) {
-    settings.dayshift_secs = (time_t)(0000*(dayshift_t->value->int32)); // multiplier here in seconds
-    redo_sky_paths();
+    settings.dayshift_secs = (time_t)(DAYSHIFT_STEP_SECS*(dayshift_t->value->int32));
   }
-  // redraw watchface
-  update_time();
-  // save settings
-  prv_save_settings();
+  // act on the new settings once the burst of messages is over
+  s_config_messages++;
+  if (!s_config_timer || !app_timer_reschedule(s_config_timer, CONFIG_SETTLE_MS))
+    s_config_timer = app_timer_register(CONFIG_SETTLE_MS, config_timer_callback, NULL);
 }
 
 static void main_window_load(Window *window) {
@@ -634,8 +723,7 @@ static void main_window_load(Window *window) {
   // create drawing canvas for data visualization -- top 40% of display
   s_canvas_layer = layer_create(
       GRect(0, 0, bounds.size.w, bounds.size.h*0.4));
-  graph_width = bounds.size.w;
-  graph_height = bounds.size.h*0.4;
+  sky_layout_init(&s_layout, bounds.size.w, bounds.size.h*0.4, PBL_IF_ROUND_ELSE(true, false));
   
   // Assign the custom drawing procedure
   layer_set_update_proc(s_canvas_layer, canvas_update_proc);
@@ -652,6 +740,7 @@ static void main_window_load(Window *window) {
   text_layer_set_text_color(s_time_layer, GColorWhite);
   text_layer_set_font(s_time_layer, fonts_get_system_font(FONT_KEY_BITHAM_42_BOLD));
   text_layer_set_text_alignment(s_time_layer, GTextAlignmentCenter);
+  text_slot_init(&s_time_text, s_time_layer);
 
   // Add it as a child layer to the Window's root layer
   layer_add_child(window_layer, text_layer_get_layer(s_time_layer));
@@ -665,7 +754,7 @@ static void main_window_load(Window *window) {
   text_layer_set_text_color(s_date_layer, GColorWhite);
   text_layer_set_text_alignment(s_date_layer, GTextAlignmentCenter);
   text_layer_set_font(s_date_layer, fonts_get_system_font(FONT_KEY_GOTHIC_24_BOLD));
-  text_layer_set_text(s_date_layer, "Date");
+  text_slot_init(&s_date_text, s_date_layer);
 
   // Add it as a child layer to the Window's root layer
   layer_add_child(window_layer, text_layer_get_layer(s_date_layer));
@@ -679,7 +768,7 @@ static void main_window_load(Window *window) {
   text_layer_set_text_color(s_info_layer, GColorWhite);
   text_layer_set_text_alignment(s_info_layer, GTextAlignmentCenter);
   text_layer_set_font(s_info_layer, fonts_get_system_font(FONT_KEY_GOTHIC_24_BOLD));
-  text_layer_set_text(s_info_layer, " ");
+  text_slot_init(&s_info_text, s_info_layer);
                                      
   // Add it as a child layer to the Window's root layer
   layer_add_child(window_layer, text_layer_get_layer(s_info_layer)); 
@@ -691,13 +780,12 @@ static void main_window_unload(Window *window) {
   text_layer_destroy(s_date_layer);
   text_layer_destroy(s_info_layer);
 
-  // Destroy canvas
+  // Destroy canvas and its cached background
   layer_destroy(s_canvas_layer);
+  sky_cache_destroy(&s_sky_cache);
   
   // Destroy the image data
-  gbitmap_destroy(s_bitmap_sun);
-  gbitmap_destroy(s_bitmap_horizon);
-  gbitmap_destroy(s_bitmap_moon);
+  sky_atlas_destroy(&s_atlas);
 }
 
 void timer_callback(){
@@ -708,6 +796,7 @@ static void accel_tap_handler(AccelAxisType axis, int32_t direction) {
   // A tap event (shake) occurred
   if (!debounce) {
     info_offset++;
+    update_positions();
     update_time();
     debounce = true;
     debounce_timer = app_timer_register(500, timer_callback, NULL);
@@ -718,12 +807,19 @@ static void accel_tap_handler(AccelAxisType axis, int32_t direction) {
 }
 
 static void init() {
+  time_t start_secs;
+  uint16_t start_ms = time_ms(&start_secs, NULL);
   prv_load_settings();
   APP_LOG(APP_LOG_LEVEL_DEBUG, "Loaded settings on start");
   
   // Open AppMessage connection
   app_message_register_inbox_received(prv_inbox_received_handler);
   app_message_open(128, 128);
+
+  // the worker fills the next days in the background, and carries on
+  // after the face closes, if the user opted in
+  app_worker_message_subscribe(worker_message_handler);
+  apply_worker_setting(true);
   
   // Subscribe to tap events -- for shake detection
   accel_tap_service_subscribe(accel_tap_handler);
@@ -746,27 +842,56 @@ static void init() {
   // Set the window background to the image background
   window_set_background_color(s_main_window, GColorBlack);
   
-  // load horizon bitmap
-  s_bitmap_horizon = gbitmap_create_with_resource(RESOURCE_ID_IMAGE_HORIZON);
+  // load the sprite atlas, the only bitmap resource the face reads
+  sky_atlas_load(&s_atlas);
   
   // calculate sun paths
   redo_sky_paths();
 
-  // load proper moon phase image
-  load_moon_image();
-
-  // get proper sun image
-  load_sun_image();
+  // current positions, then place the sun and moon and work out their looks
+  update_positions();
+  update_canvas();
+  schedule_canvas_update();
 
   // Display time
   update_time();
+
+  time_t end_secs;
+  uint16_t end_ms = time_ms(&end_secs, NULL);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Startup took %d ms",
+          (int)((end_secs - start_secs)*1000 + end_ms - start_ms));
 }
 
 static void deinit() {
   // Destroy Window
   window_destroy(s_main_window);
   prv_save_settings(); // write data if changed
-  APP_LOG(APP_LOG_LEVEL_DEBUG, "Stored setting on exit");
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Settings writes %d, avoided %d",
+          (int)s_settings_store.writes, (int)s_settings_store.writes_avoided);
+  const RenderStats *stats = render_stats();
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Text updates %d, skipped %d; canvas updates %d, skipped %d",
+          (int)stats->text_updates, (int)stats->text_skipped,
+          (int)stats->canvas_updates, (int)stats->canvas_skipped);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Canvas wakeups %d", (int)s_canvas_wakeups);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Sky path checks %d, avoided %d, store fills %d",
+          (int)s_sky_path_checks, (int)s_sky_path_avoided, (int)s_sky_store_fills);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Sky store hits %d, misses %d",
+          (int)s_stores.hits, (int)s_stores.misses);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Moon disc rebuilds %d, changes %d",
+          (int)s_moon_disc.rebuilds, (int)s_moon_disc.version);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Sun image swaps %d", (int)s_sun_swaps);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Path samples %d/%d builds",
+          (int)s_solar_samples.builds, (int)s_lunar_samples.builds);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Settings messages %d, passes %d",
+          (int)s_config_messages, (int)s_config_passes);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Sky paths asked of phone %d, received %d",
+          (int)s_link.requests, (int)s_link.completed);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Sky paths asked of worker %d, taken %d",
+          (int)s_worker.requests, (int)s_worker.completed);
+  app_worker_message_unsubscribe();
+#if defined(SKY_PROFILE)
+  profile_log();
+#endif
 }
 
 int main(void) {
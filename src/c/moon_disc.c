@@ -0,0 +1,88 @@
+#include "moon_disc.h"
+
+// Half width of each row of the disc either side of the middle column,
+// the outline of the old moon bitmaps
+static const int8_t DISC_HALF_WIDTH[MOON_DISC_SIZE] = { 2, 3, 4, 5, 6, 6, 6, 6, 6, 5, 4, 3, 2 };
+#define DISC_MIDDLE (MOON_DISC_SIZE / 2)
+// radius squared in sixteenths of a pixel, squared: (6.5 * 16)^2
+#define DISC_RADIUS2_Q8 10816
+
+// Is the pixel dx, dy from the middle lit?  Along the bright limb (u) and
+// across it (v), the terminator is the half ellipse u = c sqrt(r^2 - v^2)
+// with c = 1 - 2 * lit, running from the unlit limb at new moon to the
+// lit one at full; everything beyond it towards the bright limb is lit.
+// Lengths are in sixteenths of a pixel, so the squares fit in 32 bits.
+static bool prv_lit(int dx, int dy, int32_t limb_x, int32_t limb_y, int32_t c_q8) {
+  int32_t u = (dx * 16 * limb_x + dy * 16 * limb_y) >> 15;
+  int32_t v = (dx * 16 * limb_y - dy * 16 * limb_x) >> 15;
+  int32_t s2 = DISC_RADIUS2_Q8 - v * v;
+  if (s2 < 0) s2 = 0;
+  int32_t u2 = (u * u) << 16;
+  int32_t cs2 = c_q8 * c_q8 * s2;
+  if (c_q8 >= 0)
+    return (u > 0) && (u2 > cs2);
+  return (u >= 0) || (u2 < cs2);
+}
+
+static void prv_build_spans(MoonDisc *disc, MoonSpan spans[MOON_DISC_SIZE][2]) {
+  // bright limb direction on screen, y down: up is the zenith and the
+  // angle turns towards the left
+  int32_t limb_x = -sin_lookup(disc->limb_angle) >> 1;
+  int32_t limb_y = -cos_lookup(disc->limb_angle) >> 1;
+  int32_t c_q8 = (32768 - 2 * disc->lit_q15) >> 7;
+
+  for (int row = 0; row < MOON_DISC_SIZE; row++) {
+    MoonSpan *span = spans[row];
+    span[0].start = span[0].end = span[1].start = span[1].end = -1;
+    int count = 0;
+    bool in_span = false;
+    for (int col = DISC_MIDDLE - DISC_HALF_WIDTH[row]; col <= DISC_MIDDLE + DISC_HALF_WIDTH[row]; col++) {
+      bool lit = prv_lit(col - DISC_MIDDLE, row - DISC_MIDDLE, limb_x, limb_y, c_q8);
+      if (lit && !in_span) {
+        // a third span cannot happen with a convex terminator, but if
+        // rounding makes one, fold it into the second
+        if (count < 2) span[count++].start = col;
+        in_span = true;
+      }
+      if (lit)
+        span[count - 1].end = col;
+      else
+        in_span = false;
+    }
+  }
+}
+
+bool moon_disc_update(MoonDisc *disc, const Observer *obs, time_t t) {
+  time_t age = t - disc->computed_at;
+  if (disc->valid && (age < MOON_DISC_REFRESH_SECS) && (age > -MOON_DISC_REFRESH_SECS))
+    return false;
+  disc->computed_at = t;
+  moonIlluminationFixed(obs, t, &disc->lit_q15, &disc->limb_angle);
+
+  MoonSpan spans[MOON_DISC_SIZE][2];
+  prv_build_spans(disc, spans);
+  disc->rebuilds++;
+  bool changed = !disc->valid || (memcmp(spans, disc->spans, sizeof(spans)) != 0);
+  if (changed) {
+    memcpy(disc->spans, spans, sizeof(spans));
+    disc->version++;
+  }
+  disc->valid = true;
+  return changed;
+}
+
+void moon_disc_invalidate(MoonDisc *disc) {
+  disc->valid = false;
+}
+
+void moon_disc_draw(const MoonDisc *disc, GContext *ctx, GPoint origin) {
+  graphics_context_set_stroke_color(ctx, GColorWhite);
+  for (int row = 0; row < MOON_DISC_SIZE; row++) {
+    for (int i = 0; i < 2; i++) {
+      const MoonSpan *span = &disc->spans[row][i];
+      if (span->start < 0) continue;
+      graphics_draw_line(ctx, GPoint(origin.x + span->start, origin.y + row),
+                         GPoint(origin.x + span->end, origin.y + row));
+    }
+  }
+}
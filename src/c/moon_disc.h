@@ -0,0 +1,40 @@
+#pragma once
+#include <pebble.h>
+#include "ephemeris.h"
+//
+// The moon sprite, drawn from its actual phase instead of nine bitmaps.
+// The lit part of the disc is kept as a table of horizontal spans per row,
+// worked out from the illuminated fraction and the bright limb direction
+// whenever those are stale; a frame then only draws the spans.  Where the
+// bright limb is tilted a row can cross a crescent's horns, so each row
+// has room for two spans.
+//
+
+#define MOON_DISC_SIZE 13
+// Phase and tilt are recomputed at most this often; the terminator moves
+// about a pixel a day, the tilt a few degrees in this time
+#define MOON_DISC_REFRESH_SECS 600
+
+typedef struct MoonSpan {
+  int8_t start;   // first lit column, or -1 if none
+  int8_t end;     // last lit column
+} MoonSpan;
+
+typedef struct MoonDisc {
+  bool valid;
+  time_t computed_at;
+  int32_t lit_q15;            // illuminated fraction
+  int32_t limb_angle;         // bright limb from the zenith, trig units
+  MoonSpan spans[MOON_DISC_SIZE][2];
+  uint16_t version;           // bumped whenever the spans change
+  uint32_t rebuilds;          // span tables worked out
+} MoonDisc;
+
+// Bring the disc up to time t for obs.  Returns true if the spans changed.
+bool moon_disc_update(MoonDisc *disc, const Observer *obs, time_t t);
+
+// Recompute on the next update, e.g. after the location moved
+void moon_disc_invalidate(MoonDisc *disc);
+
+// Draw the lit spans with the disc's top left corner at origin
+void moon_disc_draw(const MoonDisc *disc, GContext *ctx, GPoint origin);
@@ -0,0 +1,36 @@
+#include "position_cache.h"
+
+static void prv_set_key(SkyPositions *pos, const Observer *obs, time_t unixtime, bool precise) {
+  pos->valid = true;
+  pos->minute = (int32_t)(unixtime / 60);
+  pos->latitude = obs->Latitude;
+  pos->longitude = obs->Longitude;
+  pos->precise = precise;
+}
+
+bool position_cache_hit(const SkyPositions *pos, const Observer *obs, time_t unixtime, bool precise) {
+  return pos->valid &&
+         (pos->minute == (int32_t)(unixtime / 60)) &&
+         (pos->latitude == obs->Latitude) &&
+         (pos->longitude == obs->Longitude) &&
+         (pos->precise || !precise);
+}
+
+void position_cache_compute(SkyPositions *pos, const Observer *obs, time_t unixtime) {
+  sunPosition(obs, unixtime, CALC_AZI, &pos->solar_azi, &pos->solar_elev);
+  moonPosition(obs, unixtime, CALC_AZI, &pos->lunar_azi, &pos->lunar_elev);
+  prv_set_key(pos, obs, unixtime, true);
+}
+
+void position_cache_from_tables(SkyPositions *pos, const Observer *obs, time_t unixtime,
+                                int32_t solar_elev_x100, int32_t lunar_elev_x100) {
+  pos->solar_elev = (float)solar_elev_x100 / 100;
+  pos->lunar_elev = (float)lunar_elev_x100 / 100;
+  pos->solar_azi = 0;
+  pos->lunar_azi = 0;
+  prv_set_key(pos, obs, unixtime, false);
+}
+
+void position_cache_invalidate(SkyPositions *pos) {
+  pos->valid = false;
+}
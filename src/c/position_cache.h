@@ -0,0 +1,31 @@
+#pragma once
+#include <pebble.h>
+#include "ephemeris.h"
+//
+// Sun and moon positions for one minute at one location.  Filled in once
+// per tick, outside the render path, and read by the drawing code.
+//
+
+typedef struct SkyPositions {
+  bool valid;
+  int32_t minute;        // unixtime / 60 the positions belong to
+  float latitude;        // observer the positions were computed for
+  float longitude;
+  bool precise;          // full pipeline with azimuth, else elevations from the hourly tables
+  float solar_elev;      // degrees
+  float solar_azi;       // degrees, only when precise
+  float lunar_elev;
+  float lunar_azi;
+} SkyPositions;
+
+// True if pos already holds this minute and location, at the asked precision
+bool position_cache_hit(const SkyPositions *pos, const Observer *obs, time_t unixtime, bool precise);
+
+// Full precision elevation and azimuth through sunPosition/moonPosition
+void position_cache_compute(SkyPositions *pos, const Observer *obs, time_t unixtime);
+
+// Cheap elevations, already interpolated from the hourly tables (x100)
+void position_cache_from_tables(SkyPositions *pos, const Observer *obs, time_t unixtime,
+                                int32_t solar_elev_x100, int32_t lunar_elev_x100);
+
+void position_cache_invalidate(SkyPositions *pos);
@@ -0,0 +1,76 @@
+#include "profile.h"
+
+#if defined(SKY_PROFILE)
+
+static const char *const SECTION_NAMES[PROFILE_SECTIONS] = {
+  [PROFILE_REDO_SKY_PATHS] = "redo",
+  [PROFILE_UPDATE_POSITIONS] = "pos",
+  [PROFILE_UPDATE_TIME] = "time",
+  [PROFILE_UPDATE_CANVAS] = "canv",
+  [PROFILE_CANVAS_DRAW] = "draw",
+};
+
+static ProfileStats s_stats[PROFILE_SECTIONS];
+static ProfileSample s_ring[PROFILE_RING_SIZE];
+static uint32_t s_ring_count;  // runs recorded, the next goes at s_ring_count % PROFILE_RING_SIZE
+
+ProfileMark profile_mark(void) {
+  ProfileMark mark;
+  mark.ms = time_ms(&mark.secs, NULL);
+  return mark;
+}
+
+void profile_record(ProfileSection section, ProfileMark start) {
+  ProfileMark end = profile_mark();
+  int32_t ms = (int32_t)(end.secs - start.secs)*1000 + end.ms - start.ms;
+  if (ms < 0) ms = 0;  // the clock was set back
+  if (ms > UINT16_MAX) ms = UINT16_MAX;
+
+  ProfileStats *stats = &s_stats[section];
+  stats->count++;
+  stats->total_ms += ms;
+  if (ms > stats->max_ms) stats->max_ms = ms;
+
+  ProfileSample *sample = &s_ring[s_ring_count % PROFILE_RING_SIZE];
+  sample->at = (uint32_t)end.secs;
+  sample->ms = ms;
+  sample->section = section;
+  s_ring_count++;
+}
+
+const char *profile_name(ProfileSection section) {
+  return SECTION_NAMES[section];
+}
+
+const ProfileStats *profile_stats(ProfileSection section) {
+  return &s_stats[section];
+}
+
+int profile_samples(ProfileSample *out, int max) {
+  int count = (s_ring_count < PROFILE_RING_SIZE) ? (int)s_ring_count : PROFILE_RING_SIZE;
+  if (count > max) count = max;
+  for (int i = 0; i < count; i++)
+    out[i] = s_ring[(s_ring_count - count + i) % PROFILE_RING_SIZE];
+  return count;
+}
+
+void profile_format(ProfileSection section, char *buffer, size_t size) {
+  const ProfileStats *stats = &s_stats[section];
+  snprintf(buffer, size, "%s %d %d/%dms", SECTION_NAMES[section], (int)stats->count,
+           stats->count ? (int)(stats->total_ms / stats->count) : 0, (int)stats->max_ms);
+}
+
+void profile_log(void) {
+  for (int i = 0; i < PROFILE_SECTIONS; i++) {
+    APP_LOG(APP_LOG_LEVEL_INFO, "Profile %s: %d runs, %d ms, max %d ms", SECTION_NAMES[i],
+            (int)s_stats[i].count, (int)s_stats[i].total_ms, (int)s_stats[i].max_ms);
+  }
+  ProfileSample samples[PROFILE_RING_SIZE];
+  int count = profile_samples(samples, PROFILE_RING_SIZE);
+  for (int i = 0; i < count; i++) {
+    APP_LOG(APP_LOG_LEVEL_INFO, "  %d %s %d ms", (int)samples[i].at,
+            SECTION_NAMES[samples[i].section], (int)samples[i].ms);
+  }
+}
+
+#endif
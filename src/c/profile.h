@@ -0,0 +1,75 @@
+#pragma once
+#include "sky_sdk.h"
+//
+// Development instrumentation, all of it compiled out of release builds.
+// APP_LOG calls generate nothing unless built with SKY_LOGGING, and the
+// profiler below only exists when built with SKY_PROFILE.  wscript takes
+// both from the environment:
+//
+//   SKY_LOGGING=1 SKY_PROFILE=1 pebble build
+//
+// The profiler keeps, for each hot function, how often it ran and its
+// total and worst time in ms from time_ms(), plus the last
+// PROFILE_RING_SIZE runs.  A profiling build adds an info item that
+// cycles through the functions, and logs everything at exit when logging
+// is on too.
+//
+
+#if !defined(SKY_LOGGING)
+#undef APP_LOG
+// the arguments are still type checked, but no code or strings remain
+#define APP_LOG(level, fmt, ...) \
+  do { if (0) app_log(level, __FILE__, __LINE__, fmt, ##__VA_ARGS__); } while (0)
+#endif
+
+typedef enum {
+  PROFILE_REDO_SKY_PATHS,
+  PROFILE_UPDATE_POSITIONS,
+  PROFILE_UPDATE_TIME,
+  PROFILE_UPDATE_CANVAS,
+  PROFILE_CANVAS_DRAW,
+  PROFILE_SECTIONS
+} ProfileSection;
+
+#if defined(SKY_PROFILE)
+
+#define PROFILE_RING_SIZE 32
+
+typedef struct ProfileStats {
+  uint32_t count;
+  uint32_t total_ms;
+  uint16_t max_ms;
+} ProfileStats;
+
+typedef struct ProfileSample {
+  uint32_t at;             // unixtime the run ended
+  uint16_t ms;
+  uint8_t section;         // ProfileSection
+} ProfileSample;
+
+typedef struct ProfileMark {
+  time_t secs;
+  uint16_t ms;
+} ProfileMark;
+
+ProfileMark profile_mark(void);
+// Account the time since start to section
+void profile_record(ProfileSection section, ProfileMark start);
+
+const char *profile_name(ProfileSection section);
+const ProfileStats *profile_stats(ProfileSection section);
+// Copy up to max of the last runs into out, oldest first; returns how many
+int profile_samples(ProfileSample *out, int max);
+// The stats of one section as a short line for the info layer
+void profile_format(ProfileSection section, char *buffer, size_t size);
+void profile_log(void);
+
+#define PROFILE_START(mark) ProfileMark mark = profile_mark()
+#define PROFILE_STOP(mark, section) profile_record((section), (mark))
+
+#else
+
+#define PROFILE_START(mark) do { } while (0)
+#define PROFILE_STOP(mark, section) do { } while (0)
+
+#endif
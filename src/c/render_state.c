@@ -0,0 +1,48 @@
+#include "render_state.h"
+
+static RenderStats s_stats;
+
+void text_slot_init(TextSlot *slot, TextLayer *layer) {
+  slot->layer = layer;
+  slot->shown[0] = '\0';
+  text_layer_set_text(layer, slot->shown);
+}
+
+bool text_slot_set(TextSlot *slot, const char *text) {
+  if (strncmp(slot->shown, text, TEXT_SLOT_SIZE) == 0) {
+    s_stats.text_skipped++;
+    return false;
+  }
+  strncpy(slot->shown, text, TEXT_SLOT_SIZE - 1);
+  slot->shown[TEXT_SLOT_SIZE - 1] = '\0';
+  text_layer_set_text(slot->layer, slot->shown);
+  s_stats.text_updates++;
+  return true;
+}
+
+static bool prv_rect_equal(GRect a, GRect b) {
+  return (a.origin.x == b.origin.x) && (a.origin.y == b.origin.y) &&
+         (a.size.w == b.size.w) && (a.size.h == b.size.h);
+}
+
+bool canvas_state_update(CanvasState *shown, const CanvasState *next, Layer *layer) {
+  bool same = shown->valid &&
+              (shown->sky_version == next->sky_version) &&
+              prv_rect_equal(shown->sun, next->sun) &&
+              prv_rect_equal(shown->moon, next->moon) &&
+              (shown->sun_image == next->sun_image) &&
+              (shown->moon_disc == next->moon_disc);
+  if (same) {
+    s_stats.canvas_skipped++;
+    return false;
+  }
+  *shown = *next;
+  shown->valid = true;
+  layer_mark_dirty(layer);
+  s_stats.canvas_updates++;
+  return true;
+}
+
+const RenderStats *render_stats() {
+  return &s_stats;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <pebble.h>
+//
+// Dirty tracking for the watchface layers.  Text is only handed to a
+// TextLayer when the formatted string differs from what it shows, and the
+// canvas is only marked dirty when something it draws has moved or changed.
+// The counters tell how many redraw requests were avoided.
+//
+
+#define TEXT_SLOT_SIZE 16
+
+// What a TextLayer currently shows.  The layer points at shown[], so the
+// caller's format buffer can be reused freely.
+typedef struct TextSlot {
+  TextLayer *layer;
+  char shown[TEXT_SLOT_SIZE];
+} TextSlot;
+
+// Everything the canvas update proc depends on
+typedef struct CanvasState {
+  bool valid;
+  uint32_t sky_version;   // bumped whenever the path tables are recomputed
+  GRect sun;              // sprite placement
+  GRect moon;
+  uint16_t sun_image;      // SkySprite
+  uint16_t moon_disc;      // MoonDisc version
+} CanvasState;
+
+typedef struct RenderStats {
+  uint32_t text_updates;
+  uint32_t text_skipped;
+  uint32_t canvas_updates;
+  uint32_t canvas_skipped;
+} RenderStats;
+
+void text_slot_init(TextSlot *slot, TextLayer *layer);
+// Show text on the slot's layer if it changed; returns true if the layer was dirtied
+bool text_slot_set(TextSlot *slot, const char *text);
+
+// Adopt next as the drawn state, marking layer dirty if it differs from shown
+bool canvas_state_update(CanvasState *shown, const CanvasState *next, Layer *layer);
+
+const RenderStats *render_stats();
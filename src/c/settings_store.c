@@ -0,0 +1,93 @@
+#include <pebble.h>
+#include "settings_store.h"
+#include "profile.h"
+
+// The ClaySettings struct as releases before SETTINGS_VERSION 1 wrote it
+// with persist_write_data, run time fields and padding included
+typedef struct LegacySettings {
+  float Latitude;
+  float Longitude;
+  bool ShowInfo;
+  time_t dayshift_secs;
+  int info_display;
+  int curr_solar_elev_int;
+  int curr_solar_azi_int;
+  int curr_lunar_elev_int;
+  int curr_lunar_azi_int;
+} LegacySettings;
+
+// hundredths of a degree, rounded; the phone sends no finer than that
+static int16_t prv_x100(float degrees) {
+  return (int16_t)(degrees * 100 + ((degrees < 0) ? -0.5f : 0.5f));
+}
+
+static void prv_pack(const ClaySettings *settings, SettingsRecord *record) {
+  memset(record, 0, sizeof(*record));
+  record->version = SETTINGS_VERSION;
+  record->flags = (settings->ShowInfo ? SETTINGS_FLAG_SHOW_INFO : 0) |
+                  (settings->BackgroundWorker ? SETTINGS_FLAG_BACKGROUND_WORKER : 0) |
+                  (settings->worker_asked ? SETTINGS_FLAG_WORKER_ASKED : 0);
+  record->info_display = (uint8_t)settings->info_display;
+  record->latitude_x100 = prv_x100(settings->Latitude);
+  record->longitude_x100 = prv_x100(settings->Longitude);
+  record->dayshift_secs = (int32_t)settings->dayshift_secs;
+}
+
+static void prv_unpack(const SettingsRecord *record, ClaySettings *settings) {
+  settings->Latitude = record->latitude_x100 / 100.0f;
+  settings->Longitude = record->longitude_x100 / 100.0f;
+  settings->ShowInfo = (record->flags & SETTINGS_FLAG_SHOW_INFO) != 0;
+  settings->BackgroundWorker = (record->flags & SETTINGS_FLAG_BACKGROUND_WORKER) != 0;
+  settings->worker_asked = (record->flags & SETTINGS_FLAG_WORKER_ASKED) != 0;
+  settings->info_display = record->info_display;
+  settings->dayshift_secs = record->dayshift_secs;
+}
+
+bool settings_store_load(SettingsStore *store, uint32_t key, ClaySettings *settings) {
+  // big enough for either layout; the size read tells them apart
+  union {
+    SettingsRecord record;
+    LegacySettings legacy;
+  } stored;
+  int size = persist_read_data(key, &stored, sizeof(stored));
+  store->stored = false;
+
+  if ((size == sizeof(SettingsRecord)) && (stored.record.version == SETTINGS_VERSION)) {
+    store->saved = stored.record;
+    store->stored = true;
+    prv_unpack(&stored.record, settings);
+    return true;
+  }
+  if (size == sizeof(LegacySettings)) {
+    settings->Latitude = stored.legacy.Latitude;
+    settings->Longitude = stored.legacy.Longitude;
+    settings->ShowInfo = stored.legacy.ShowInfo;
+    settings->dayshift_secs = stored.legacy.dayshift_secs;
+    settings->info_display = stored.legacy.info_display;
+    // store what the new record holds, so the next load gives the same
+    SettingsRecord record;
+    prv_pack(settings, &record);
+    prv_unpack(&record, settings);
+    settings_store_save(store, key, settings);
+    store->migrations++;
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "Migrated settings to version %d", SETTINGS_VERSION);
+    return true;
+  }
+  if (size > 0)
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "Stored settings rejected, %d bytes", size);
+  return false;
+}
+
+bool settings_store_save(SettingsStore *store, uint32_t key, const ClaySettings *settings) {
+  SettingsRecord record;
+  prv_pack(settings, &record);
+  if (store->stored && (memcmp(&record, &store->saved, sizeof(record)) == 0)) {
+    store->writes_avoided++;
+    return false;
+  }
+  persist_write_data(key, &record, sizeof(record));
+  store->saved = record;
+  store->stored = true;
+  store->writes++;
+  return true;
+}
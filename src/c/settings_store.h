@@ -0,0 +1,56 @@
+#pragma once
+#include <pebble.h>
+//
+// The configuration from the phone, kept in persistent storage as a small
+// versioned record.  A save only writes flash when the record differs
+// from the one last read or written, so exits and repeated settings
+// messages that change nothing cost no flash write.  Anything derived
+// at run time (positions, tables) does not belong here.
+//
+
+// 1: compact record with a version byte, replaces the raw ClaySettings
+// struct of earlier releases, which is migrated on load
+#define SETTINGS_VERSION 1
+
+typedef struct ClaySettings {
+  float Latitude;
+  float Longitude;
+  bool ShowInfo;
+  time_t dayshift_secs;
+  int info_display;
+  bool BackgroundWorker;  // the user opted in to the worker, see sky_worker.h
+  bool worker_asked;      // the last launch of the worker asked to replace another app's
+} ClaySettings;
+
+// ClaySettings as stored, fixed width and without padding so the bytes
+// can be compared directly
+typedef struct SettingsRecord {
+  uint8_t version;
+  uint8_t flags;            // SETTINGS_FLAG_*
+  uint8_t info_display;
+  uint8_t spare;            // always 0
+  int16_t latitude_x100;
+  int16_t longitude_x100;
+  int32_t dayshift_secs;
+} SettingsRecord;
+
+#define SETTINGS_FLAG_SHOW_INFO 0x01
+#define SETTINGS_FLAG_BACKGROUND_WORKER 0x02
+#define SETTINGS_FLAG_WORKER_ASKED 0x04
+
+typedef struct SettingsStore {
+  bool stored;              // saved holds what is in flash
+  SettingsRecord saved;
+  uint32_t writes;
+  uint32_t writes_avoided;  // saves that found the record unchanged
+  uint32_t migrations;
+} SettingsStore;
+
+// Read the settings stored under key over the defaults in settings,
+// migrating an old layout (and writing it back in the new one).  False,
+// leaving settings alone, if nothing usable is stored.
+bool settings_store_load(SettingsStore *store, uint32_t key, ClaySettings *settings);
+
+// Write settings under key unless the stored record already matches.
+// True if flash was written.
+bool settings_store_save(SettingsStore *store, uint32_t key, const ClaySettings *settings);
@@ -0,0 +1,43 @@
+#include "sky_atlas.h"
+#include "profile.h"
+
+// Where each sprite sits in RESOURCE_ID_IMAGE_SKY_ATLAS, as printed by
+// tools/atlas/make_sky_atlas.py
+static const GRect SPRITE_RECTS[SKY_SPRITE_COUNT] = {
+  [SKY_SPRITE_SUN_RIM] = { { 0, 0 }, { 15, 13 } },
+  [SKY_SPRITE_SUN_RISEN] = { { 15, 0 }, { 15, 13 } },
+  [SKY_SPRITE_HORIZON] = { { 30, 0 }, { 4, 28 } },
+};
+
+bool sky_atlas_load(SkyAtlas *atlas) {
+  atlas->atlas = gbitmap_create_with_resource(RESOURCE_ID_IMAGE_SKY_ATLAS);
+  if (atlas->atlas == NULL) {
+    APP_LOG(APP_LOG_LEVEL_ERROR, "Sky atlas did not load");
+    return false;
+  }
+  for (int i = 0; i < SKY_SPRITE_COUNT; i++) {
+    atlas->sprites[i] = gbitmap_create_as_sub_bitmap(atlas->atlas, SPRITE_RECTS[i]);
+    if (atlas->sprites[i] == NULL) {
+      APP_LOG(APP_LOG_LEVEL_ERROR, "Sky atlas sprite %d did not load", i);
+      sky_atlas_destroy(atlas);
+      return false;
+    }
+  }
+  return true;
+}
+
+GBitmap *sky_atlas_sprite(const SkyAtlas *atlas, SkySprite sprite) {
+  return atlas->sprites[sprite];
+}
+
+void sky_atlas_destroy(SkyAtlas *atlas) {
+  // views first, they point into the atlas
+  for (int i = 0; i < SKY_SPRITE_COUNT; i++) {
+    if (atlas->sprites[i] != NULL)
+      gbitmap_destroy(atlas->sprites[i]);
+    atlas->sprites[i] = NULL;
+  }
+  if (atlas->atlas != NULL)
+    gbitmap_destroy(atlas->atlas);
+  atlas->atlas = NULL;
+}
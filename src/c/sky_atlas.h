@@ -0,0 +1,28 @@
+#pragma once
+#include <pebble.h>
+//
+// All the bitmap sprites of the sky canvas in one resource.  The atlas is
+// loaded once and each sprite is a sub-bitmap view into it, so switching
+// sprites never touches the heap or the resource store.  The atlas is made
+// by tools/atlas/make_sky_atlas.py.
+//
+
+typedef enum {
+  SKY_SPRITE_SUN_RIM,
+  SKY_SPRITE_SUN_RISEN,
+  SKY_SPRITE_HORIZON,
+  SKY_SPRITE_COUNT
+} SkySprite;
+
+typedef struct SkyAtlas {
+  GBitmap *atlas;
+  GBitmap *sprites[SKY_SPRITE_COUNT];
+} SkyAtlas;
+
+// Load the atlas resource and make the sprite views.  Returns false if out
+// of memory, with nothing left allocated.
+bool sky_atlas_load(SkyAtlas *atlas);
+
+GBitmap *sky_atlas_sprite(const SkyAtlas *atlas, SkySprite sprite);
+
+void sky_atlas_destroy(SkyAtlas *atlas);
@@ -0,0 +1,65 @@
+#include <pebble.h>
+#include "sky_path.h"
+#include "sky_bands.h"
+
+// Lowest elevation of each band, x100.  Day starts where the sun's upper
+// limb clears the horizon, as at sunrise in sky_events.c.
+static const int16_t BAND_FLOOR_X100[SKY_BAND_NIGHT] = { -83, -600, -1200, -1800 };
+
+#if !defined(PBL_BW)
+static const GColor BAND_COLORS[SKY_BAND_NIGHT] = {
+  GColorVividCerulean, GColorCobaltBlue, GColorDukeBlue, GColorOxfordBlue
+};
+#endif
+
+static uint8_t prv_band(int32_t elev_x100) {
+  uint8_t band = SKY_BAND_DAY;
+  while ((band < SKY_BAND_NIGHT) && (elev_x100 < BAND_FLOOR_X100[band]))
+    band++;
+  return band;
+}
+
+void sky_bands_build(SkyBands *bands, const SkyLayout *layout, const int16_t *solar_elev_x100) {
+  int width = (int)layout->graph_width;
+  bands->count = 0;
+  for (int x = 0; x < width; x++) {
+    // the middle of the column, in minutes of the day
+    int minutes = (2*x + 1)*24*60 / (2*width);
+    uint8_t band = prv_band(sky_path_elev_at(solar_elev_x100, minutes / 60, minutes % 60));
+    if (bands->count > 0) {
+      SkyBandSpan *last = &bands->spans[bands->count - 1];
+      if ((last->band == band) || (bands->count == SKY_BANDS_MAX_SPANS)) {
+        last->end = x;
+        continue;
+      }
+    }
+    SkyBandSpan *span = &bands->spans[bands->count++];
+    span->start = span->end = x;
+    span->band = band;
+  }
+  bands->builds++;
+}
+
+void sky_bands_draw(const SkyBands *bands, GContext *ctx, const SkyLayout *layout) {
+#if !defined(PBL_BW)
+  int width = layout->graph_width;
+  GRect dial = GRect(layout->center.x - layout->radius, layout->center.y - layout->radius,
+                     2*layout->radius, 2*layout->radius);
+  for (int i = 0; i < bands->count; i++) {
+    const SkyBandSpan *span = &bands->spans[i];
+    if (span->band == SKY_BAND_NIGHT)
+      continue;
+    graphics_context_set_fill_color(ctx, BAND_COLORS[span->band]);
+    if (layout->polar) {
+      // the span's wedge, clockwise from midnight at the bottom of the dial
+      int32_t start = TRIG_MAX_ANGLE * span->start / width + TRIG_MAX_ANGLE / 2;
+      int32_t end = TRIG_MAX_ANGLE * (span->end + 1) / width + TRIG_MAX_ANGLE / 2;
+      graphics_fill_radial(ctx, dial, GOvalScaleModeFitCircle, layout->radius, start, end);
+    }
+    else {
+      graphics_fill_rect(ctx, GRect(span->start, 0, span->end - span->start + 1, layout->graph_height),
+                         0, GCornerNone);
+    }
+  }
+#endif
+}
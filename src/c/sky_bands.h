@@ -0,0 +1,43 @@
+#pragma once
+#include <pebble.h>
+#include "sky_layout.h"
+//
+// Day, twilight and night shading behind the sky paths.  When the tables
+// are redone, every column of the canvas is classed by the sun's elevation
+// at its hour, and the runs of equal columns are kept as spans; a frame
+// then fills one rectangle per span, or on a dial the wedge of the hours
+// the span's columns cover.  Black and white watches have no
+// shades to spare and leave the sky black.
+//
+
+typedef enum {
+  SKY_BAND_DAY,
+  SKY_BAND_CIVIL,          // sun below the horizon, above -6 degrees
+  SKY_BAND_NAUTICAL,       // -6 to -12
+  SKY_BAND_ASTRONOMICAL,   // -12 to -18
+  SKY_BAND_NIGHT,
+  SKY_BAND_COUNT
+} SkyBand;
+
+// A day rarely has more than nine spans; a sun skimming a threshold makes more,
+// and those past the limit are folded into the last span
+#define SKY_BANDS_MAX_SPANS 16
+
+typedef struct SkyBandSpan {
+  uint8_t start;   // first column
+  uint8_t end;     // last column
+  uint8_t band;    // SkyBand
+} SkyBandSpan;
+
+typedef struct SkyBands {
+  uint8_t count;
+  SkyBandSpan spans[SKY_BANDS_MAX_SPANS];
+  uint32_t builds;
+} SkyBands;
+
+// Class the columns of layout from the 25 row hourly solar table
+void sky_bands_build(SkyBands *bands, const SkyLayout *layout, const int16_t *solar_elev_x100);
+
+// Fill the spans as layout draws the sky.  Night is the canvas's own black
+// and is not drawn.
+void sky_bands_draw(const SkyBands *bands, GContext *ctx, const SkyLayout *layout);
@@ -0,0 +1,59 @@
+#include "sky_cache.h"
+
+// Copy the bounds rows of the frame buffer into the cache bitmap
+static void prv_copy_rows(GBitmap *dst, GBitmap *frame, GRect bounds) {
+#if defined(PBL_BW)
+  // 1 bit rows are plain bytes on aplite/diorite
+  uint8_t *src_data = gbitmap_get_data(frame);
+  uint8_t *dst_data = gbitmap_get_data(dst);
+  uint16_t src_stride = gbitmap_get_bytes_per_row(frame);
+  uint16_t dst_stride = gbitmap_get_bytes_per_row(dst);
+  uint16_t row_bytes = (src_stride < dst_stride) ? src_stride : dst_stride;
+  for (int y = 0; y < bounds.size.h; y++) {
+    memcpy(dst_data + y * dst_stride, src_data + (bounds.origin.y + y) * src_stride, row_bytes);
+  }
+#else
+  // 8 bit, and on chalk each frame buffer row only covers part of the width
+  for (int y = 0; y < bounds.size.h; y++) {
+    GBitmapDataRowInfo src = gbitmap_get_data_row_info(frame, bounds.origin.y + y);
+    GBitmapDataRowInfo out = gbitmap_get_data_row_info(dst, y);
+    int min_x = (src.min_x > bounds.origin.x) ? src.min_x : bounds.origin.x;
+    int max_x = bounds.origin.x + bounds.size.w - 1;
+    if (src.max_x < max_x) max_x = src.max_x;
+    if (max_x >= min_x)
+      memcpy(out.data + min_x - bounds.origin.x, src.data + min_x, max_x - min_x + 1);
+  }
+#endif
+}
+
+static bool prv_capture(SkyCache *cache, GContext *ctx, GRect bounds) {
+  if (cache->bitmap == NULL) {
+    cache->bitmap = gbitmap_create_blank(bounds.size, PBL_IF_BW_ELSE(GBitmapFormat1Bit, GBitmapFormat8Bit));
+    if (cache->bitmap == NULL) return false;  // out of memory, keep drawing directly
+  }
+  GBitmap *frame = graphics_capture_frame_buffer(ctx);
+  if (frame == NULL) return false;
+  prv_copy_rows(cache->bitmap, frame, bounds);
+  graphics_release_frame_buffer(ctx, frame);
+  return true;
+}
+
+void sky_cache_draw(SkyCache *cache, GContext *ctx, GRect bounds, uint32_t version,
+                    SkyDrawProc draw) {
+  if (cache->valid && (cache->version == version)) {
+    graphics_context_set_compositing_mode(ctx, GCompOpAssign);
+    graphics_draw_bitmap_in_rect(ctx, cache->bitmap, bounds);
+    cache->blits++;
+    return;
+  }
+  draw(ctx);
+  cache->renders++;
+  cache->valid = prv_capture(cache, ctx, bounds);
+  cache->version = version;
+}
+
+void sky_cache_destroy(SkyCache *cache) {
+  if (cache->bitmap != NULL) gbitmap_destroy(cache->bitmap);
+  cache->bitmap = NULL;
+  cache->valid = false;
+}
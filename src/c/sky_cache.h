@@ -0,0 +1,30 @@
+#pragma once
+#include <pebble.h>
+//
+// Offscreen copy of the static part of the sky canvas (paths and horizon).
+// The background is drawn once into the frame buffer, copied out, and
+// blitted back on later frames until its version changes.
+//
+// Cost is one canvas-sized bitmap in the frame buffer's format:
+//   aplite   144 x 67, 1 bit    1.3 kB
+//   basalt   144 x 67, 8 bit    9.4 kB
+//   chalk    180 x 72, 8 bit   12.7 kB
+//   emery    200 x 91, 8 bit   17.8 kB
+//
+
+typedef void (*SkyDrawProc)(GContext *ctx);
+
+typedef struct SkyCache {
+  GBitmap *bitmap;
+  bool valid;
+  uint32_t version;
+  uint32_t blits;      // frames served from the cache
+  uint32_t renders;    // frames that had to draw the background
+} SkyCache;
+
+// Draw the background for version into bounds (frame buffer coordinates of
+// a layer at the window origin), using draw only when the cache is stale
+void sky_cache_draw(SkyCache *cache, GContext *ctx, GRect bounds, uint32_t version,
+                    SkyDrawProc draw);
+
+void sky_cache_destroy(SkyCache *cache);
@@ -0,0 +1,29 @@
+#include "sky_clock.h"
+
+static uint16_t prv_watch_clock(time_t *secs) {
+  return time_ms(secs, NULL);
+}
+
+static SkyClockSource s_source = prv_watch_clock;
+static time_t s_shift_secs = 0;
+
+void sky_clock_set_source(SkyClockSource source) {
+  s_source = source ? source : prv_watch_clock;
+}
+
+void sky_clock_set_shift(time_t shift_secs) {
+  s_shift_secs = shift_secs;
+}
+
+time_t sky_clock_now(void) {
+  time_t secs;
+  s_source(&secs);
+  return secs;
+}
+
+time_t sky_clock_shifted(uint16_t *ms) {
+  time_t secs;
+  uint16_t now_ms = s_source(&secs);
+  if (ms) *ms = now_ms;
+  return secs + s_shift_secs;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "sky_sdk.h"
+//
+// Where the face reads the time.  On the watch the source is time_ms();
+// the host replay harness (tools/bench/replay_year.c) installs a simulated
+// clock instead, so every entry point can be stepped through a year.  The
+// Dayshift setting moves the time the face shows, not the clock itself.
+//
+
+// Like time_ms(): fills in the seconds and returns the milliseconds
+typedef uint16_t (*SkyClockSource)(time_t *secs);
+
+// NULL puts back time_ms()
+void sky_clock_set_source(SkyClockSource source);
+void sky_clock_set_shift(time_t shift_secs);
+
+// The clock as it is, for timeouts and the like; time(NULL) on the watch
+time_t sky_clock_now(void);
+
+// The time the face shows: the clock plus the Dayshift.  ms may be NULL.
+time_t sky_clock_shifted(uint16_t *ms);
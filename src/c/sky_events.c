@@ -0,0 +1,152 @@
+#include <pebble.h>
+#include "ephemeris.h"
+#include "sky_path.h"
+#include "sky_events.h"
+#include "profile.h"
+
+// Altitude of the centre at each event.  At rise and set the sun's centre
+// is still below the horizon, by refraction plus its semi-diameter.  The
+// moon's altitude already includes its parallax, so the same holds for it
+// with its own mean semi-diameter.
+#define SUN_RISE_ALT -0.833f
+#define MOON_RISE_ALT -0.825f
+#define CIVIL_ALT -6.0f
+#define NAUTICAL_ALT -12.0f
+
+// Refinement stops once a step is below this; the display shows minutes
+#define CONVERGED_SECS 20
+#define MAX_ITERATIONS 6
+
+static float prv_altitude(SkyEvents *events, SkyBody body, const Observer *obs, time_t t) {
+  float azi, alt;
+  events->evaluations++;
+  if (body == SKY_BODY_SUN)
+    sunPosition(obs, t, NO_AZI, &azi, &alt);
+  else
+    moonPosition(obs, t, NO_AZI, &azi, &alt);
+  return alt;
+}
+
+// Where body crosses alt between the table rows at t_lo and an hour later,
+// where the table reads alt + f_lo and alt + f_hi.  Starts from the linear
+// guess, takes one Newton step on the table's slope, then secant steps
+// through the last two evaluations.
+static time_t prv_refine_crossing(SkyEvents *events, SkyBody body, const Observer *obs, float alt,
+                                  time_t t_lo, float f_lo, float f_hi) {
+  // times are seconds after t_lo
+  float slope = (f_hi - f_lo)/SECS_IN_HOUR;
+  float t0 = -f_lo/slope;
+  float f0 = prv_altitude(events, body, obs, t_lo + (time_t)t0) - alt;
+  float t1 = t0 - f0/slope;
+  for (int i = 0; (i < MAX_ITERATIONS) && (fabs_pebble(t1 - t0) >= CONVERGED_SECS); i++) {
+    // a grazing crossing can send the secant far off, stay near the bracket
+    if (t1 < -SECS_IN_HOUR) t1 = -SECS_IN_HOUR;
+    if (t1 > 2*SECS_IN_HOUR) t1 = 2*SECS_IN_HOUR;
+    float f1 = prv_altitude(events, body, obs, t_lo + (time_t)t1) - alt;
+    if (f1 == f0)
+      break;
+    float t2 = t1 - f1*(t1 - t0)/(f1 - f0);
+    t0 = t1;
+    f0 = f1;
+    t1 = t2;
+  }
+  return t_lo + round_to_int(t1);
+}
+
+// First time body crosses alt going up (rising) or down, or SKY_EVENT_NONE
+static time_t prv_crossing(SkyEvents *events, SkyBody body, const Observer *obs,
+                           const int16_t *elev_x100, time_t start, float alt, bool rising) {
+  for (int i = 0; i < 24; i++) {
+    float f_lo = elev_x100[i]/100.0f - alt;
+    float f_hi = elev_x100[i+1]/100.0f - alt;
+    if (rising ? ((f_lo < 0) && (f_hi >= 0)) : ((f_lo >= 0) && (f_hi < 0)))
+      return prv_refine_crossing(events, body, obs, alt, start + i*SECS_IN_HOUR, f_lo, f_hi);
+  }
+  return SKY_EVENT_NONE;
+}
+
+// Offset of the top of the parabola through three equally spaced points,
+// in units of their spacing
+static float prv_vertex(float y_before, float y, float y_after) {
+  float curve = y_before - 2*y + y_after;
+  if (curve >= 0)
+    return 0;  // not a maximum
+  return 0.5f*(y_before - y_after)/curve;
+}
+
+// The sun's hour angle, negative before noon, in trig units
+static int32_t prv_hour_angle(SkyEvents *events, const Observer *obs, time_t t) {
+  int32_t dec, ra;
+  events->evaluations++;
+  sunCoordsFixed(t, &dec, &ra);
+  int32_t H = (siderealAngle(obs, t) - ra) & (TRIG_MAX_ANGLE - 1);
+  return (H >= TRIG_MAX_ANGLE/2) ? H - TRIG_MAX_ANGLE : H;
+}
+
+// Solar noon, when the hour angle is zero.  The top of the table gives the
+// first guess; altitude is too flat there (and has a cusp near the zenith)
+// to refine on, but the hour angle runs a turn a day, so Newton steps on it
+// converge at once.
+static time_t prv_solar_noon(SkyEvents *events, const Observer *obs,
+                             const int16_t *elev_x100, time_t start) {
+  int peak = 0;
+  for (int i = 1; i <= 24; i++)
+    if (elev_x100[i] > elev_x100[peak]) peak = i;
+  if ((peak == 0) || (peak == 24))
+    return SKY_EVENT_NONE;  // the day's top is at its edge, no noon inside it
+
+  time_t noon = start + peak*SECS_IN_HOUR +
+                round_to_int(prv_vertex(elev_x100[peak-1], elev_x100[peak], elev_x100[peak+1])*SECS_IN_HOUR);
+  for (int i = 0; i < MAX_ITERATIONS; i++) {
+    // SECS_IN_DAY/TRIG_MAX_ANGLE seconds per trig unit, reduced to stay in 32 bits
+    int32_t step = prv_hour_angle(events, obs, noon) * (SECS_IN_DAY/64) / (TRIG_MAX_ANGLE/64);
+    noon -= step;
+    if ((step < CONVERGED_SECS) && (step > -CONVERGED_SECS))
+      break;
+  }
+  return noon;
+}
+
+bool sky_events_update(SkyEvents *events, const Observer *obs, time_t midnight,
+                       const int16_t *solar_elev_x100, time_t table_start) {
+  if (events->valid && (events->midnight == midnight) &&
+      (events->latitude == obs->Latitude) && (events->longitude == obs->Longitude))
+    return false;
+
+  int16_t solar_own[25];
+  int16_t lunar_elev_x100[25];
+  if (!solar_elev_x100 || (table_start != midnight)) {
+    sky_path_fill(SKY_BODY_SUN, obs, midnight, 25, SECS_IN_HOUR, solar_own);
+    solar_elev_x100 = solar_own;
+  }
+  // the watchface's lunar table is shifted to line up under the sun, so
+  // the moon gets a table of its own for the day
+  sky_path_fill(SKY_BODY_MOON, obs, midnight, 25, SECS_IN_HOUR, lunar_elev_x100);
+
+  events->evaluations = 0;
+  time_t *t = events->time;
+  t[SKY_EVENT_SUNRISE] = prv_crossing(events, SKY_BODY_SUN, obs, solar_elev_x100, midnight, SUN_RISE_ALT, true);
+  t[SKY_EVENT_SUNSET] = prv_crossing(events, SKY_BODY_SUN, obs, solar_elev_x100, midnight, SUN_RISE_ALT, false);
+  t[SKY_EVENT_SOLAR_NOON] = prv_solar_noon(events, obs, solar_elev_x100, midnight);
+  t[SKY_EVENT_CIVIL_DAWN] = prv_crossing(events, SKY_BODY_SUN, obs, solar_elev_x100, midnight, CIVIL_ALT, true);
+  t[SKY_EVENT_CIVIL_DUSK] = prv_crossing(events, SKY_BODY_SUN, obs, solar_elev_x100, midnight, CIVIL_ALT, false);
+  t[SKY_EVENT_NAUTICAL_DAWN] = prv_crossing(events, SKY_BODY_SUN, obs, solar_elev_x100, midnight, NAUTICAL_ALT, true);
+  t[SKY_EVENT_NAUTICAL_DUSK] = prv_crossing(events, SKY_BODY_SUN, obs, solar_elev_x100, midnight, NAUTICAL_ALT, false);
+  t[SKY_EVENT_MOONRISE] = prv_crossing(events, SKY_BODY_MOON, obs, lunar_elev_x100, midnight, MOON_RISE_ALT, true);
+  t[SKY_EVENT_MOONSET] = prv_crossing(events, SKY_BODY_MOON, obs, lunar_elev_x100, midnight, MOON_RISE_ALT, false);
+
+  events->solved = 0;
+  for (int i = 0; i < SKY_EVENT_COUNT; i++)
+    if (t[i] != SKY_EVENT_NONE) events->solved++;
+  events->midnight = midnight;
+  events->latitude = obs->Latitude;
+  events->longitude = obs->Longitude;
+  events->valid = true;
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Solved %d events with %d evaluations",
+          (int)events->solved, (int)events->evaluations);
+  return true;
+}
+
+void sky_events_invalidate(SkyEvents *events) {
+  events->valid = false;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <pebble.h>
+#include "ephemeris.h"
+//
+// Rise, set, solar noon and twilight times for one day at one location.
+// Sign changes are bracketed in the hourly elevation tables, then refined
+// with a few evaluations of sunPosition/moonPosition.  The result is kept
+// until the day or the location changes.
+//
+
+typedef enum {
+  SKY_EVENT_SUNRISE,
+  SKY_EVENT_SUNSET,
+  SKY_EVENT_SOLAR_NOON,
+  SKY_EVENT_CIVIL_DAWN,
+  SKY_EVENT_CIVIL_DUSK,
+  SKY_EVENT_NAUTICAL_DAWN,
+  SKY_EVENT_NAUTICAL_DUSK,
+  SKY_EVENT_MOONRISE,
+  SKY_EVENT_MOONSET,
+  SKY_EVENT_COUNT
+} SkyEvent;
+
+// Event time when the event does not happen that day (polar day or night)
+#define SKY_EVENT_NONE 0
+
+typedef struct SkyEvents {
+  bool valid;
+  time_t midnight;        // start of the day the events belong to
+  float latitude;         // observer the events were solved for
+  float longitude;
+  time_t time[SKY_EVENT_COUNT];
+  uint16_t evaluations;   // sunPosition/moonPosition calls the last solve made
+  uint8_t solved;         // events found by the last solve
+} SkyEvents;
+
+// Solve the events of the day starting at midnight, unless they are already
+// cached.  solar_elev_x100 is the 25 point hourly table of the sun from
+// table_start; if it does not start at midnight the solver builds its own.
+// Returns true if the events were solved anew.
+bool sky_events_update(SkyEvents *events, const Observer *obs, time_t midnight,
+                       const int16_t *solar_elev_x100, time_t table_start);
+
+void sky_events_invalidate(SkyEvents *events);
@@ -0,0 +1,226 @@
+#include <pebble.h>
+#include <stdlib.h>
+#include "ephemeris.h"
+#include "sky_path.h"
+#include "sky_layout.h"
+
+// Sprites stop sinking below this elevation, x100
+#define LOWEST_SPRITE_ELEV_X100 -700
+// No body's elevation changes faster than the earth turns plus the moon's
+// own motion, about 15.6 degrees an hour: 26 x100 a minute
+#define MAX_ELEV_X100_PER_MIN 26
+#define MINUTES_IN_DAY (24*60)
+#define QUARTER_MINUTES 15
+
+// y scale based upon latitude
+static void prv_elev_scale(float latitude, int *top, int *range) {
+  *range = (90 - fabs_pebble(latitude) + TILT_OF_EARTH) * 1.35;  // full graph 135% of the potential range at that lat
+  if (*range>110) *range = 110;
+  *top = (90 - fabs_pebble(latitude) + TILT_OF_EARTH) * 1.05;  // this gives a 30% buffer below the horizon.
+  if (*top>90) *top = 90;
+}
+
+static void prv_build_depths(SkyLayout *layout) {
+  for (int i = 0; i <= SKY_LAYOUT_DEGREES; i++) {
+    int elev = i - 90;
+    if (layout->polar)
+      // the lowest elevation shown at the centre, the highest at the rim
+      layout->elev_depth[i] = (elev - (layout->top - layout->range)) * layout->radius * 16 / layout->range;
+    else
+      layout->elev_depth[i] = (layout->top - elev) * layout->graph_height * 16 / layout->range;
+  }
+}
+
+void sky_layout_init(SkyLayout *layout, int width, int height, bool polar) {
+  layout->graph_width = width;
+  layout->graph_height = height;
+  layout->polar = polar;
+  layout->center = GPoint(width / 2, height / 2);
+  layout->radius = ((width < height) ? width : height) / 2;
+  for (int i = 0; i <= SKY_LAYOUT_QUARTERS; i++) {
+    if (polar) {
+      // clockwise from midnight at the bottom, so noon is at the top
+      int32_t angle = TRIG_MAX_ANGLE * i / SKY_LAYOUT_QUARTERS + TRIG_MAX_ANGLE / 2;
+      layout->hour_x[i] = sin_lookup(angle) / 4;
+      layout->hour_y[i] = -cos_lookup(angle) / 4;
+    }
+    else {
+      // width = 0 to 24 hours
+      layout->hour_x[i] = i * width * 16 / SKY_LAYOUT_QUARTERS;
+      layout->hour_y[i] = 0;
+    }
+  }
+  // the elevation table is built for the new size whatever the latitude
+  layout->range = 0;
+  sky_layout_set_latitude(layout, layout->latitude);
+}
+
+bool sky_layout_set_latitude(SkyLayout *layout, float latitude) {
+  int top, range;
+  layout->latitude = latitude;
+  prv_elev_scale(latitude, &top, &range);
+  if ((top == layout->top) && (range == layout->range))
+    return false;
+  layout->top = top;
+  layout->range = range;
+  prv_build_depths(layout);
+  return true;
+}
+
+static int32_t prv_lerp(const int16_t *table, int i, int32_t rem, int32_t span) {
+  return table[i] + (table[i+1] - table[i]) * rem / span;
+}
+
+// Elevation table position of elev_x100, in 1/16 pixels
+static int32_t prv_depth_q4(const SkyLayout *layout, int32_t elev_x100) {
+  int32_t from_bottom = elev_x100 + 9000;
+  int i = (from_bottom < 0) ? 0 : from_bottom / 100;
+  if (i > SKY_LAYOUT_DEGREES - 1) i = SKY_LAYOUT_DEGREES - 1;
+  return prv_lerp(layout->elev_depth, i, from_bottom - i*100, 100);
+}
+
+// The point in 1/16 pixels
+static void prv_point_q4(const SkyLayout *layout, int32_t minute, int32_t elev_x100,
+                         int32_t *x, int32_t *y) {
+  if (layout->polar) {
+    minute %= MINUTES_IN_DAY;
+    if (minute < 0) minute += MINUTES_IN_DAY;
+  }
+  int i = (minute < 0) ? 0 : minute / QUARTER_MINUTES;
+  if (i > SKY_LAYOUT_QUARTERS - 1) i = SKY_LAYOUT_QUARTERS - 1;
+  int32_t rem = minute - i*QUARTER_MINUTES;
+  int32_t depth = prv_depth_q4(layout, elev_x100);
+  if (layout->polar) {
+    *x = layout->center.x*16 + ((depth * prv_lerp(layout->hour_x, i, rem, QUARTER_MINUTES)) >> 14);
+    *y = layout->center.y*16 + ((depth * prv_lerp(layout->hour_y, i, rem, QUARTER_MINUTES)) >> 14);
+  }
+  else {
+    *x = prv_lerp(layout->hour_x, i, rem, QUARTER_MINUTES);
+    *y = depth;
+  }
+}
+
+GPoint sky_layout_point(const SkyLayout *layout, int32_t minute, int32_t elev_x100) {
+  int32_t x, y;
+  prv_point_q4(layout, minute, elev_x100, &x, &y);
+  return GPoint(x >> 4, y >> 4);
+}
+
+int sky_layout_depth(const SkyLayout *layout, int32_t elev_x100) {
+  return prv_depth_q4(layout, elev_x100) >> 4;
+}
+
+int sky_tables_lunar_index(const SkyTables *tables, int hour) {
+  int index = hour + tables->lunar_offset_hour - 24*tables->lunar_day_shift;
+  return ((index < 0) || (index > 23)) ? -1 : index;
+}
+
+bool sky_layout_sun_risen(int32_t elev_x100, bool was_risen) {
+  return elev_x100 >= (was_risen ? SUN_SET_ELEV_X100 : SUN_RISEN_ELEV_X100);
+}
+
+// Where the moon is shown at solar hour:minute: its display minute, and its
+// elevation x100 held at the lowest a sprite goes
+static void prv_moon_at(const SkyTables *tables, int hour, int minute, float lunar_elev,
+                        int32_t *moon_minute, int32_t *elev_x100) {
+  int lunar_hour = (hour + tables->lunar_offset_hour) % 24;
+  if (lunar_hour<0) lunar_hour = lunar_hour + 24;
+  int lunar_index = sky_tables_lunar_index(tables, hour);
+  *elev_x100 = (lunar_index < 0) ? round_to_int(lunar_elev*100) :
+               sky_path_elev_at(tables->lunar_elev_x100, lunar_index, minute);
+  // If moon is too low, stop lowering its position
+  if (*elev_x100 < LOWEST_SPRITE_ELEV_X100) *elev_x100 = LOWEST_SPRITE_ELEV_X100;
+  // the lunar display minute, wrapped into the day
+  *moon_minute = (lunar_hour*60 + minute + tables->lunar_fine_shift_min + MINUTES_IN_DAY) % MINUTES_IN_DAY;
+}
+
+void sky_layout_sprites(const SkyLayout *layout, const SkyTables *tables,
+                        int hour, int minute, float lunar_elev, bool sun_risen, SkySprites *sprites) {
+  int32_t curr_elev, curr_minute;
+  GPoint point;
+
+  // Place the sun
+  curr_elev = sky_path_elev_at(tables->solar_elev_x100, hour, minute);
+  sprites->sun_risen = sky_layout_sun_risen(curr_elev, sun_risen);
+  // If sun is too low, stop lowering its position
+  if (curr_elev < LOWEST_SPRITE_ELEV_X100) curr_elev = LOWEST_SPRITE_ELEV_X100;
+  // Get the location to place the sun
+  point = sky_layout_point(layout, hour*60 + minute, curr_elev);
+  sprites->sun = GRect(point.x-7,point.y-6,15,13);
+
+  // Now place the moon
+  prv_moon_at(tables, hour, minute, lunar_elev, &curr_minute, &curr_elev);
+  point = sky_layout_point(layout, curr_minute, curr_elev);
+  sprites->moon = GRect(point.x-6,point.y-6,13,13);
+}
+
+static bool prv_rect_equal(GRect a, GRect b) {
+  return (a.origin.x == b.origin.x) && (a.origin.y == b.origin.y) &&
+         (a.size.w == b.size.w) && (a.size.h == b.size.h);
+}
+
+// Distance in 1/16 pixels from v (1/16 pixels) to the nearest pixel edge
+static int32_t prv_edge_q4(int32_t v) {
+  int32_t px = v & 15;
+  return (px > 8) ? 16 - px : px;
+}
+
+// Whether an elevation we cannot look ahead on (the moon outside its table)
+// could have moved its sprite to another pixel by m minutes on, where it
+// would be if the elevation held.  Elevation moves the sprite down the
+// rectangle, but along the radius of the dial, so there the nearer of its
+// x and y pixel edges counts.
+static bool prv_moon_may_move(const SkyLayout *layout, const SkyTables *tables,
+                              int hour, int minute, float lunar_elev, int m) {
+  int32_t moon_minute, elev_x100, x, y;
+  prv_moon_at(tables, hour, minute, lunar_elev, &moon_minute, &elev_x100);
+  prv_point_q4(layout, moon_minute, elev_x100, &x, &y);
+  int32_t margin = prv_edge_q4(y);
+  if (layout->polar && (prv_edge_q4(x) < margin)) margin = prv_edge_q4(x);
+  // the table is a straight line rounded to 1/16 pixels, so no step of
+  // it is more than one past its mean
+  int32_t q4_per_degree = abs(layout->elev_depth[SKY_LAYOUT_DEGREES] - layout->elev_depth[0]) /
+                          SKY_LAYOUT_DEGREES + 1;
+  return m * MAX_ELEV_X100_PER_MIN * q4_per_degree >= margin * 100;
+}
+
+int sky_layout_minutes_to_move(const SkyLayout *layout, const SkyTables *tables,
+                               int hour, int minute, float lunar_elev, bool sun_risen, int max_minutes) {
+  SkySprites now, next;
+  sky_layout_sprites(layout, tables, hour, minute, lunar_elev, sun_risen, &now);
+
+  // the table cannot tell where the moon goes, so only look as far as it
+  // cannot have changed pixel
+  bool unseen = sky_tables_lunar_index(tables, hour) < 0;
+  bool pinned = false;
+  if (unseen) {
+    int32_t elev_x100 = round_to_int(lunar_elev*100);
+    if (elev_x100 < LOWEST_SPRITE_ELEV_X100) {
+      // pinned at the bottom until it rises past the limit
+      int bound = (LOWEST_SPRITE_ELEV_X100 - elev_x100) / MAX_ELEV_X100_PER_MIN;
+      if (bound < 1) bound = 1;
+      if (bound < max_minutes) max_minutes = bound;
+      pinned = true;
+    }
+  }
+
+  // stepping a minute at a time is a few dozen multiplies, far cheaper than
+  // the redraw it saves
+  int m;
+  for (m = 1; m < max_minutes; m++) {
+    int total = hour*60 + minute + m;
+    if (total >= 24*60)
+      return m;  // new day, new tables
+    int next_hour = total / 60;
+    if ((next_hour != hour) && (sky_tables_lunar_index(tables, next_hour) < 0))
+      return m;  // the moon leaves its table here
+    // the image state carries over from minute to minute, as on the canvas
+    sky_layout_sprites(layout, tables, next_hour, total % 60, lunar_elev, now.sun_risen, &next);
+    if (!prv_rect_equal(now.sun, next.sun) || !prv_rect_equal(now.moon, next.moon) ||
+        (now.sun_risen != next.sun_risen))
+      return m;
+    if (unseen && !pinned && prv_moon_may_move(layout, tables, next_hour, total % 60, lunar_elev, m))
+      return m;
+  }
+  return max_minutes;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <pebble.h>
+//
+// Where the sky graph puts things: hour of day across the canvas, elevation
+// up it.  Round watches get a dial instead, hour of day around it with
+// midnight at the bottom and elevation out from the centre.  Also
+// predicts when a sprite will next land on a different pixel, so the
+// canvas can sleep until then instead of refreshing every minute.
+//
+// Both shapes are drawn from integer tables in 1/16 pixels, one entry per
+// quarter hour and one per degree of elevation, built when the canvas or
+// the latitude changes; a point is two table interpolations.
+//
+
+#define SKY_LAYOUT_QUARTERS (24*4)
+#define SKY_LAYOUT_DEGREES 180   // elevation table from -90 to 90
+
+// Canvas size, the latitude that sets the elevation scale, and the tables
+// built from them.  Set up with sky_layout_init() and sky_layout_set_latitude().
+typedef struct SkyLayout {
+  int16_t graph_width;
+  int16_t graph_height;
+  float latitude;
+  bool polar;            // the dial rather than the rectangle
+  GPoint center;         // of the dial
+  int16_t radius;        // of the dial, where the highest elevation shown lies
+  int16_t top;           // elevation scale, whole degrees: shown at the top or rim
+  int16_t range;         // and this many below it at the bottom or centre
+  // x, or on the dial the sine of its angle in Q14, per quarter hour
+  int16_t hour_x[SKY_LAYOUT_QUARTERS + 1];
+  // on the dial minus the cosine of its angle in Q14, per quarter hour
+  int16_t hour_y[SKY_LAYOUT_QUARTERS + 1];
+  // y, or on the dial the distance from the centre, per degree from -90
+  int16_t elev_depth[SKY_LAYOUT_DEGREES + 1];
+} SkyLayout;
+
+// The hourly tables from redo_sky_paths() and how the lunar one is shifted
+typedef struct SkyTables {
+  const int16_t *solar_elev_x100;
+  const int16_t *lunar_elev_x100;
+  int lunar_offset_hour;
+  int lunar_day_shift;
+  int lunar_fine_shift_min;   // what rounding to the hour left, in minutes
+} SkyTables;
+
+// What the canvas shows of the sun and moon at a given minute
+typedef struct SkySprites {
+  GRect sun;
+  GRect moon;
+  bool sun_risen;   // selects the risen or rim image
+} SkySprites;
+
+// The sun shows risen once it is SUN_RISEN_ELEV degrees up, and stays so
+// until it sinks below SUN_SET_ELEV, so a sun skimming the horizon (or
+// tables redone with slightly different numbers) cannot flip the image
+// back and forth
+#define SUN_RISEN_ELEV_X100 100
+#define SUN_SET_ELEV_X100 0
+
+// Size the canvas and build the hour table; the elevation table follows
+// from the latitude
+void sky_layout_init(SkyLayout *layout, int width, int height, bool polar);
+
+// Rebuild the elevation table if latitude changes the scale.  Returns true
+// if it did, and points drawn before are stale.
+bool sky_layout_set_latitude(SkyLayout *layout, float latitude);
+
+// Screen point of an elevation (x100) at a minute of the day.  On the dial
+// minutes wrap around midnight; across the rectangle they run off its sides.
+GPoint sky_layout_point(const SkyLayout *layout, int32_t minute, int32_t elev_x100);
+
+// Rows below the top (rectangle) or pixels out from the centre (dial) an
+// elevation is drawn at; the horizon is sky_layout_depth(layout, 0)
+int sky_layout_depth(const SkyLayout *layout, int32_t elev_x100);
+
+
+// Row of the lunar table for a solar hour, or -1 if the table does not cover it
+int sky_tables_lunar_index(const SkyTables *tables, int hour);
+
+// The sun image state at elevation elev_x100, given the state before
+bool sky_layout_sun_risen(int32_t elev_x100, bool was_risen);
+
+// Place the sprites at hour:minute from the tables.  Where the lunar table
+// does not cover the hour, lunar_elev is used for the moon instead.
+// sun_risen is the sun image state the canvas shows now.
+void sky_layout_sprites(const SkyLayout *layout, const SkyTables *tables,
+                        int hour, int minute, float lunar_elev, bool sun_risen, SkySprites *sprites);
+
+// Minutes from hour:minute until the sprites differ from those at hour:minute,
+// at most max_minutes and never past midnight.  If the moon is placed from
+// lunar_elev the answer is a safe lower bound instead of exact.
+int sky_layout_minutes_to_move(const SkyLayout *layout, const SkyTables *tables,
+                               int hour, int minute, float lunar_elev, bool sun_risen, int max_minutes);
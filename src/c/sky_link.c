@@ -0,0 +1,71 @@
+#include <pebble.h>
+#include "sky_link.h"
+#include "profile.h"
+
+bool sky_link_request(SkyLink *link, const Observer *obs, time_t midnight, time_t now) {
+  if (link->pending && (now - link->requested_at < SKY_LINK_TIMEOUT_SECS))
+    return false;
+  if (!connection_service_peek_pebble_app_connection())
+    return false;
+
+  DictionaryIterator *iter;
+  if (app_message_outbox_begin(&iter) != APP_MSG_OK)
+    return false;
+  dict_write_int32(iter, MESSAGE_KEY_SkyRequest, (int32_t)midnight);
+  dict_write_int32(iter, MESSAGE_KEY_SkyLatitude, round_to_int(obs->Latitude*100));
+  dict_write_int32(iter, MESSAGE_KEY_SkyLongitude, round_to_int(obs->Longitude*100));
+  if (app_message_outbox_send() != APP_MSG_OK)
+    return false;
+
+  link->pending = true;
+  link->requested_at = now;
+  link->midnight = midnight;
+  link->latitude = obs->Latitude;
+  link->longitude = obs->Longitude;
+  link->solar_rows = 0;
+  link->lunar_rows = 0;
+  link->requests++;
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Asked phone for sky paths");
+  return true;
+}
+
+bool sky_link_receive(SkyLink *link, DictionaryIterator *iter) {
+  Tuple *request_t = dict_find(iter, MESSAGE_KEY_SkyRequest);
+  Tuple *body_t = dict_find(iter, MESSAGE_KEY_SkyBody);
+  Tuple *row_t = dict_find(iter, MESSAGE_KEY_SkyRow);
+  Tuple *data_t = dict_find(iter, MESSAGE_KEY_SkyData);
+  if (!link->pending || !request_t || !body_t || !row_t || !data_t ||
+      (request_t->value->int32 != (int32_t)link->midnight))
+    return false;  // not an answer to the request that is out
+
+  bool moon = (body_t->value->int32 == SKY_BODY_MOON);
+  uint16_t *received = moon ? &link->lunar_rows : &link->solar_rows;
+  int16_t *grid = moon ? link->store.lunar_elev_x100 : link->store.solar_elev_x100;
+  int total = moon ? SKY_STORE_LUNAR_ROWS : SKY_STORE_SOLAR_ROWS;
+  int row = row_t->value->int32;
+  int count = data_t->length / 2;
+
+  // rows come in order; a repeat is ignored, a gap drops the request
+  if (row < *received)
+    return false;
+  if ((row > *received) || (row + count > total)) {
+    APP_LOG(APP_LOG_LEVEL_WARNING, "Sky path rows out of order, dropped request");
+    link->pending = false;
+    return false;
+  }
+  const uint8_t *data = data_t->value->data;
+  for (int i = 0; i < count; i++)
+    grid[row + i] = (int16_t)(data[2*i] | (data[2*i + 1] << 8));
+  *received += count;
+
+  if ((link->solar_rows < SKY_STORE_SOLAR_ROWS) || (link->lunar_rows < SKY_STORE_LUNAR_ROWS))
+    return false;
+  link->store.start = (int32_t)link->midnight;
+  link->store.latitude = link->latitude;
+  link->store.longitude = link->longitude;
+  link->store.version = SKY_STORE_VERSION;
+  link->pending = false;
+  link->completed++;
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Sky paths from phone complete");
+  return true;
+}
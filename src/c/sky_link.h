@@ -0,0 +1,38 @@
+#pragma once
+#include <pebble.h>
+#include "ephemeris.h"
+#include "sky_store.h"
+//
+// Sky path grids from the phone.  The watch asks for the SkyStore grids of
+// a location and first day; PebbleKit JS (src/pkjs/sky_tables.js) computes
+// them in double precision and streams them back SKY_LINK_ROWS at a time,
+// as little-endian int16 in SkyData.  Until a complete set has arrived the
+// watch keeps using the grids it computes itself.
+//
+
+// Rows per message; with SkyRequest, SkyBody and SkyRow alongside, a
+// message stays under the 128 byte inbox
+#define SKY_LINK_ROWS 40
+// A request with no complete answer by then may be made again
+#define SKY_LINK_TIMEOUT_SECS 60
+
+typedef struct SkyLink {
+  bool pending;           // a request is out
+  time_t requested_at;
+  time_t midnight;        // first day asked for
+  float latitude;         // observer asked for
+  float longitude;
+  uint16_t solar_rows;    // rows received so far, in order
+  uint16_t lunar_rows;
+  uint32_t requests;
+  uint32_t completed;
+  SkyStore store;         // filled as the rows arrive
+} SkyLink;
+
+// Ask the phone for the grids from midnight, unless it is not connected or
+// a request is already out.  Returns true if a request was sent.
+bool sky_link_request(SkyLink *link, const Observer *obs, time_t midnight, time_t now);
+
+// Take the rows of a phone message (one with SkyRequest in it).  Returns
+// true when that completes link->store.
+bool sky_link_receive(SkyLink *link, DictionaryIterator *iter);
@@ -0,0 +1,178 @@
+#include "sky_path.h"
+//
+// The run of points is split into halves of at most half a day.  Right
+// ascension and declination are only evaluated at the half boundaries, each
+// shared by the halves either side (an hourly day has three: start, middle,
+// end); in between right ascension is taken as linear in time, and sin
+// and cos of declination are interpolated linearly.  With right ascension
+// linear, the hour angle H = sidereal - ra advances by a fixed amount every
+// step, so cos(H) and sin(H) follow the angle addition recurrence
+//
+//   cos(H + dH) = cos(H) cos(dH) - sin(H) sin(dH)
+//   sin(H + dH) = sin(H) cos(dH) + cos(H) sin(dH)
+//
+// and each point costs a handful of multiplies plus asin_angle().  Hour
+// angle is reseeded from the sidereal time at every boundary, and every
+// dozen steps within a half so fine steps cannot drift.  The moon's
+// parallax is interpolated the same way and taken off each altitude as in
+// moonPositionFixed().
+//
+// Everything is in trig units and Q15, as in ephemeris_fixed.c.
+//
+
+#define ANGLE_MASK (TRIG_MAX_ANGLE - 1)
+#define MUL_Q15(a, b) (((a) * (b)) >> 15)
+#define Q15_TO_ATAN2(a) ((int16_t)((a) >> 2))
+// Nodes are at most this far apart, as in the hourly tables
+#define NODE_SPACING_SECS (SECS_IN_DAY/2)
+// Hour angle is looked up afresh every this many steps
+#define RESEED_STEPS 12
+
+typedef struct SkyNode {
+  int32_t ra;
+  int32_t sin_dec;
+  int32_t cos_dec;
+  int32_t sidereal;
+  int32_t parallax;   // zero for the sun
+} SkyNode;
+
+static void prv_node(SkyBody body, const Observer *obs, time_t t, SkyNode *node) {
+  int32_t ra, dec, parallax = 0;
+  if (body == SKY_BODY_SUN)
+    sunCoordsFixed(t, &dec, &ra);
+  else
+    moonCoordsFixed(t, &ra, &dec, &parallax);
+  node->ra = ra;
+  node->sin_dec = sin_lookup(dec) >> 1;
+  node->cos_dec = cos_lookup(dec) >> 1;
+  node->sidereal = siderealAngle(obs, t);
+  node->parallax = parallax;
+}
+
+// wrapped difference b - a as a signed angle, -half turn to +half turn
+static int32_t prv_signed_diff(int32_t b, int32_t a) {
+  return ((b - a + TRIG_MAX_ANGLE/2) & ANGLE_MASK) - TRIG_MAX_ANGLE/2;
+}
+
+// Where the points go: trig units (and azimuth, if azi is set) for the
+// batch functions, hundredths of a degree for the tables
+typedef struct SkySink {
+  int32_t *azi;
+  int32_t *alt;
+  int16_t *elev_x100;
+} SkySink;
+
+// Step from node a to node b, writing steps+1 points starting at index first
+static void prv_fill_half(const Observer *obs, const SkyNode *a, const SkyNode *b,
+                          int steps, const SkySink *sink, int first) {
+  // sidereal time only moves forward and the half is shorter than a
+  // sidereal day, so the wrapped difference is the true advance
+  int32_t dH_total = ((b->sidereal - a->sidereal) & ANGLE_MASK) - prv_signed_diff(b->ra, a->ra);
+  int32_t dH = (dH_total + steps/2) / steps;
+  int32_t cos_step = cos_lookup(dH) >> 1;
+  int32_t sin_step = sin_lookup(dH) >> 1;
+
+  int32_t H0 = a->sidereal - a->ra;
+  int32_t cos_H = 0, sin_H = 0;
+  int32_t d_sin_dec = b->sin_dec - a->sin_dec;
+  int32_t d_cos_dec = b->cos_dec - a->cos_dec;
+  int32_t d_parallax = b->parallax - a->parallax;
+
+  for (int i = 0; i <= steps; i++) {
+    if ((i % RESEED_STEPS == 0) && (i < steps)) {
+      // the rounded step drifts from the true hour angle, restart from it
+      // (the last point is the next half's first, which reseeds anyway)
+      int32_t H = H0 + dH_total * i / steps;
+      cos_H = cos_lookup(H) >> 1;
+      sin_H = sin_lookup(H) >> 1;
+    }
+    int32_t sin_dec = a->sin_dec + d_sin_dec * i / steps;
+    int32_t cos_dec = a->cos_dec + d_cos_dec * i / steps;
+    int32_t sin_alt = MUL_Q15(obs->sin_phi_q15, sin_dec) +
+                      MUL_Q15(MUL_Q15(obs->cos_phi_q15, cos_dec), cos_H);
+    int32_t alt = asin_angle(sin_alt);
+    if (a->parallax) {
+      int32_t parallax = a->parallax + d_parallax * i / steps;
+      alt -= MUL_Q15(parallax, cos_lookup(alt) >> 1);
+    }
+    if (sink->alt)
+      sink->alt[first + i] = alt;
+    else
+      sink->elev_x100[first + i] = (int16_t)angle_to_x100(alt);
+    if (sink->azi) {
+      // as in moonPositionFixed(), the parallax leaves the azimuth alone
+      int32_t y = MUL_Q15(sin_H, cos_dec);
+      int32_t x = MUL_Q15(MUL_Q15(cos_H, obs->sin_phi_q15), cos_dec) - MUL_Q15(sin_dec, obs->cos_phi_q15);
+      sink->azi[first + i] = (atan2_lookup(Q15_TO_ATAN2(y), Q15_TO_ATAN2(x)) + TRIG_MAX_ANGLE/2) & ANGLE_MASK;
+    }
+
+    int32_t next_cos = MUL_Q15(cos_H, cos_step) - MUL_Q15(sin_H, sin_step);
+    sin_H = MUL_Q15(sin_H, cos_step) + MUL_Q15(cos_H, sin_step);
+    cos_H = next_cos;
+  }
+}
+
+// count at least 2 and step_secs positive, see prv_valid_span()
+static void prv_fill(SkyBody body, const Observer *obs, time_t start, int count,
+                     int32_t step_secs, const SkySink *sink) {
+  int steps = count - 1;
+  int per_half = (NODE_SPACING_SECS / step_secs > 0) ? NODE_SPACING_SECS / step_secs : 1;
+  int halves = (steps + per_half - 1) / per_half;
+  SkyNode a, b;
+
+  prv_node(body, obs, start, &a);
+  for (int h = 0; h < halves; h++) {
+    int first = steps * h / halves;
+    int last = steps * (h + 1) / halves;
+    prv_node(body, obs, start + (time_t)last * step_secs, &b);
+    // the boundary point is written by both halves; the later one reseeds it
+    prv_fill_half(obs, &a, &b, last - first, sink, first);
+    a = b;
+  }
+}
+
+// prv_fill() takes steps forward through the span
+static bool prv_valid_span(int count, int32_t step_secs) {
+  return (count >= 2) && (step_secs > 0);
+}
+
+bool sky_path_fill(SkyBody body, const Observer *obs, time_t start, int count,
+                   int32_t step_secs, int16_t *elev_x100) {
+  if (!prv_valid_span(count, step_secs))
+    return false;
+  SkySink sink = { .elev_x100 = elev_x100 };
+  prv_fill(body, obs, start, count, step_secs, &sink);
+  return true;
+}
+
+// A single point has no step to take, so it goes through the scalar kernel
+static bool prv_batch(SkyBody body, const Observer *obs, time_t start, int32_t step_secs,
+                      int count, int32_t *azi, int32_t *alt) {
+  if (count == 1) {
+    int32_t unused;
+    if (body == SKY_BODY_SUN)
+      sunPositionFixed(obs, start, azi ? CALC_AZI : NO_AZI, azi ? azi : &unused, alt);
+    else
+      moonPositionFixed(obs, start, azi ? CALC_AZI : NO_AZI, azi ? azi : &unused, alt);
+    return true;
+  }
+  if (!prv_valid_span(count, step_secs))
+    return false;
+  SkySink sink = { .azi = azi, .alt = alt };
+  prv_fill(body, obs, start, count, step_secs, &sink);
+  return true;
+}
+
+bool sunPositionBatch(const Observer *obs, time_t start, int32_t step_secs, int count,
+                      int32_t *azi, int32_t *alt) {
+  return prv_batch(SKY_BODY_SUN, obs, start, step_secs, count, azi, alt);
+}
+
+bool moonPositionBatch(const Observer *obs, time_t start, int32_t step_secs, int count,
+                       int32_t *azi, int32_t *alt) {
+  return prv_batch(SKY_BODY_MOON, obs, start, step_secs, count, azi, alt);
+}
+
+int32_t sky_path_elev_at(const int16_t *elev_x100, int index, int minute) {
+  return elev_x100[index] + (elev_x100[index+1] - elev_x100[index]) * minute / 60;
+}
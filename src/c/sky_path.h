@@ -0,0 +1,38 @@
+#pragma once
+#include "sky_sdk.h"
+#include "ephemeris.h"
+//
+// Elevation tables for the sky paths, generated by stepping rather than by
+// evaluating the full position pipeline at every point, and the same
+// stepping offered as a batched position API.
+//
+
+typedef enum {
+  SKY_BODY_SUN,
+  SKY_BODY_MOON
+} SkyBody;
+
+// Fill elev_x100[0..count-1] with the elevation of body, in hundredths of a
+// degree, at start + i*step_secs.  count must be at least 2 and step_secs
+// positive; otherwise nothing is written and false returned.  The position
+// pipeline runs once every half day of the span, however long it is.
+bool sky_path_fill(SkyBody body, const Observer *obs, time_t start, int count,
+                   int32_t step_secs, int16_t *elev_x100);
+
+// Batched positions: alt[i] (and azi[i], unless azi is NULL) at
+// start + i*step_secs for i < count, in the units of sunPositionFixed() and
+// moonPositionFixed().  The work those repeat for every call (the mean
+// anomaly and ecliptic longitude, the lunar series, the obliquity rotation)
+// is done once per half day of the span and shared by the points between,
+// each of which then costs a few multiplies; azimuth adds one lookup.
+// Within about a tenth of a degree of the scalar kernel
+// (tools/bench/bench_batch.c).  count must be at least 1, and step_secs
+// positive if it is more; otherwise nothing is written and false returned.
+bool sunPositionBatch(const Observer *obs, time_t start, int32_t step_secs, int count,
+                      int32_t *azi, int32_t *alt);
+bool moonPositionBatch(const Observer *obs, time_t start, int32_t step_secs, int count,
+                       int32_t *azi, int32_t *alt);
+
+// Elevation x100 at index + minute/60 of an hourly table, linearly
+// interpolated.  index must be below the last entry.
+int32_t sky_path_elev_at(const int16_t *elev_x100, int index, int minute);
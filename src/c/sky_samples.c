@@ -0,0 +1,18 @@
+#include <pebble.h>
+#include "sky_samples.h"
+
+bool sky_samples_update(SkySamples *samples, SkyBody body, const Observer *obs, time_t start) {
+  if (samples->valid && (samples->body == body) && (samples->start == start) &&
+      (samples->latitude == obs->Latitude) && (samples->longitude == obs->Longitude))
+    return false;
+
+  sky_path_fill(body, obs, start, SKY_SAMPLES_COUNT, SECS_IN_HOUR / SKY_SAMPLES_PER_HOUR,
+                samples->elev_x100);
+  samples->body = body;
+  samples->start = start;
+  samples->latitude = obs->Latitude;
+  samples->longitude = obs->Longitude;
+  samples->builds++;
+  samples->valid = true;
+  return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <pebble.h>
+#include "ephemeris.h"
+#include "sky_path.h"
+//
+// The points a sky path is drawn through: the day at quarter hours, in
+// one stepped pass of the watch's own kernel at the exact location.  A
+// stepped fill's cost is in the span's nodes, not its points, so fewer
+// or unevenly placed points would save next to nothing (50 lookups for
+// the sun and 223 for the moon, against 38 and 139 for the hourly table),
+// and one source keeps the curve free of steps between models.  Each
+// path is a fixed 194 bytes.  tools/bench/bench_samples.c compares it
+// with drawing through the hourly table.
+//
+
+#define SKY_SAMPLES_PER_HOUR 4
+#define SKY_SAMPLES_COUNT (24*SKY_SAMPLES_PER_HOUR + 1)
+
+typedef struct SkySamples {
+  bool valid;
+  SkyBody body;
+  time_t start;           // time of the first sample
+  float latitude;         // observer the samples were built for
+  float longitude;
+  int16_t elev_x100[SKY_SAMPLES_COUNT];
+  uint32_t builds;
+} SkySamples;
+
+// Rebuild the samples of body for the day from start, unless they are
+// already for it.  Returns true if rebuilt.
+bool sky_samples_update(SkySamples *samples, SkyBody body, const Observer *obs, time_t start);
+
+// Minutes from the start of sample i
+#define SKY_SAMPLES_MINUTE(i) ((i) * (60 / SKY_SAMPLES_PER_HOUR))
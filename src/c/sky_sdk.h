@@ -0,0 +1,13 @@
+#pragma once
+//
+// The SDK header for the binary being built.  The sources the background
+// worker shares with the face (the list in wscript) include this instead of
+// <pebble.h>, so in the worker build, which wscript gives SKY_WORKER, they
+// see only <pebble_worker.h> and any call a worker cannot make fails to
+// compile there.
+//
+#ifdef SKY_WORKER
+#include <pebble_worker.h>
+#else
+#include <pebble.h>
+#endif
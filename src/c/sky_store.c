@@ -0,0 +1,216 @@
+#include "sky_sdk.h"
+#include <stddef.h>
+#include "sky_store.h"
+#include "profile.h"
+
+// the checksum covers everything after its own field
+#define CHECKED_OFFSET offsetof(SkyStore, start)
+
+// Fletcher-16.  The store is small enough that 32 bit sums cannot
+// overflow, so the modulo is taken once at the end instead of per byte.
+static uint16_t prv_checksum(const SkyStore *store) {
+  const uint8_t *bytes = (const uint8_t *)store + CHECKED_OFFSET;
+  uint32_t sum1 = 0, sum2 = 0;
+  for (size_t i = 0; i < sizeof(SkyStore) - CHECKED_OFFSET; i++) {
+    sum1 += bytes[i];
+    sum2 += sum1;
+  }
+  return ((sum2 % 255) << 8) | (sum1 % 255);
+}
+
+// One pass over the whole grid, so the days share their boundary nodes.
+// The nodes fall every twelve hours, as they did a day at a time.
+static void prv_fill_grid(SkyBody body, const Observer *obs, time_t start, int rows, int16_t *elev_x100) {
+  sky_path_fill(body, obs, start, rows, SECS_IN_HOUR, elev_x100);
+}
+
+void sky_store_fill(SkyStore *store, const Observer *obs, time_t midnight) {
+  store->start = (int32_t)midnight;
+  store->latitude = obs->Latitude;
+  store->longitude = obs->Longitude;
+  prv_fill_grid(SKY_BODY_SUN, obs, midnight, SKY_STORE_SOLAR_ROWS, store->solar_elev_x100);
+  prv_fill_grid(SKY_BODY_MOON, obs, midnight - SKY_STORE_LUNAR_LEAD_HOURS*SECS_IN_HOUR,
+                SKY_STORE_LUNAR_ROWS, store->lunar_elev_x100);
+  store->version = SKY_STORE_VERSION;
+}
+
+static int32_t prv_place_step(float degrees) {
+  return round_to_int(degrees * SKY_STORE_STEPS_PER_DEGREE);
+}
+
+static bool prv_same_place(const SkyStore *store, float latitude, float longitude) {
+  return (prv_place_step(store->latitude) == prv_place_step(latitude)) &&
+         (prv_place_step(store->longitude) == prv_place_step(longitude));
+}
+
+bool sky_store_table(const SkyStore *store, const Observer *obs, SkyBody body,
+                     time_t start, int16_t *elev_x100) {
+  if ((store->version != SKY_STORE_VERSION) ||
+      !prv_same_place(store, obs->Latitude, obs->Longitude))
+    return false;
+
+  time_t grid_start = store->start;
+  int rows = SKY_STORE_SOLAR_ROWS;
+  const int16_t *grid = store->solar_elev_x100;
+  if (body == SKY_BODY_MOON) {
+    grid_start -= SKY_STORE_LUNAR_LEAD_HOURS*SECS_IN_HOUR;
+    rows = SKY_STORE_LUNAR_ROWS;
+    grid = store->lunar_elev_x100;
+  }
+  time_t offset = start - grid_start;
+  if ((offset < 0) || (offset % SECS_IN_HOUR != 0))
+    return false;
+  int row = offset / SECS_IN_HOUR;
+  if (row + 25 > rows)
+    return false;
+  memcpy(elev_x100, &grid[row], 25*sizeof(int16_t));
+  return true;
+}
+
+bool sky_store_load(SkyStore *store, uint32_t first_key) {
+  uint8_t *bytes = (uint8_t *)store;
+  for (size_t i = 0; i < SKY_STORE_KEYS; i++) {
+    size_t offset = i*PERSIST_DATA_MAX_LENGTH;
+    size_t size = sizeof(SkyStore) - offset;
+    if (size > PERSIST_DATA_MAX_LENGTH) size = PERSIST_DATA_MAX_LENGTH;
+    if (persist_read_data(first_key + i, bytes + offset, size) != (int)size) {
+      store->version = 0;
+      return false;
+    }
+  }
+  if ((store->version != SKY_STORE_VERSION) || (store->checksum != prv_checksum(store))) {
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "Stored sky paths rejected, version %d", (int)store->version);
+    store->version = 0;
+    return false;
+  }
+  return true;
+}
+
+void sky_store_save(SkyStore *store, uint32_t first_key) {
+  store->checksum = prv_checksum(store);
+  const uint8_t *bytes = (const uint8_t *)store;
+  for (size_t i = 0; i < SKY_STORE_KEYS; i++) {
+    size_t offset = i*PERSIST_DATA_MAX_LENGTH;
+    size_t size = sizeof(SkyStore) - offset;
+    if (size > PERSIST_DATA_MAX_LENGTH) size = PERSIST_DATA_MAX_LENGTH;
+    persist_write_data(first_key + i, bytes + offset, size);
+  }
+}
+
+static void prv_touch(SkyStoreCache *cache, int slot) {
+  cache->used[slot] = ++cache->clock;
+}
+
+// The slot holding the location, else the least recently used one (empty
+// slots were never used)
+static int prv_slot_for(const SkyStoreCache *cache, float latitude, float longitude) {
+  int oldest = 0;
+  for (int slot = 0; slot < SKY_STORE_SLOTS; slot++) {
+    const SkyStore *store = &cache->slots[slot];
+    if ((store->version == SKY_STORE_VERSION) && prv_same_place(store, latitude, longitude))
+      return slot;
+    if (cache->used[slot] < cache->used[oldest])
+      oldest = slot;
+  }
+  return oldest;
+}
+
+void sky_store_cache_load(SkyStoreCache *cache, uint32_t first_key) {
+  for (int slot = 0; slot < SKY_STORE_SLOTS; slot++)
+    sky_store_load(&cache->slots[slot], first_key + slot*SKY_STORE_KEYS);
+  // rank the loaded stores by when they were filled, oldest first
+  for (int slot = 0; slot < SKY_STORE_SLOTS; slot++) {
+    cache->used[slot] = 0;
+    if (cache->slots[slot].version != SKY_STORE_VERSION)
+      continue;
+    for (int other = 0; other < SKY_STORE_SLOTS; other++)
+      if ((cache->slots[other].version == SKY_STORE_VERSION) &&
+          ((cache->slots[other].start < cache->slots[slot].start) ||
+           ((cache->slots[other].start == cache->slots[slot].start) && (other < slot))))
+        cache->used[slot]++;
+    cache->used[slot]++;
+  }
+  cache->clock = SKY_STORE_SLOTS;
+}
+
+// The slot for obs, and whether it holds the tables from midnight and lunar_start
+static int prv_lookup(const SkyStoreCache *cache, const Observer *obs, time_t midnight,
+                      time_t lunar_start, bool *found) {
+  int slot = prv_slot_for(cache, obs->Latitude, obs->Longitude);
+  const SkyStore *store = &cache->slots[slot];
+  int16_t table[25];
+  *found = sky_store_table(store, obs, SKY_BODY_SUN, midnight, table) &&
+           sky_store_table(store, obs, SKY_BODY_MOON, lunar_start, table);
+  return slot;
+}
+
+SkyStore *sky_store_cache_get(SkyStoreCache *cache, const Observer *obs, time_t midnight,
+                              time_t lunar_start, bool *filled) {
+  bool found;
+  int slot = prv_lookup(cache, obs, midnight, lunar_start, &found);
+  SkyStore *store = &cache->slots[slot];
+  prv_touch(cache, slot);
+  *filled = !found;
+  if (*filled) {
+    cache->misses++;
+    sky_store_fill(store, obs, midnight);
+  }
+  else
+    cache->hits++;
+  return store;
+}
+
+SkyStore *sky_store_cache_find(SkyStoreCache *cache, const Observer *obs, time_t midnight,
+                               time_t lunar_start) {
+  bool found;
+  int slot = prv_lookup(cache, obs, midnight, lunar_start, &found);
+  if (!found)
+    return NULL;
+  prv_touch(cache, slot);
+  cache->hits++;
+  return &cache->slots[slot];
+}
+
+SkyStore *sky_store_cache_put(SkyStoreCache *cache, const SkyStore *store) {
+  int slot = prv_slot_for(cache, store->latitude, store->longitude);
+  prv_touch(cache, slot);
+  cache->slots[slot] = *store;
+  return &cache->slots[slot];
+}
+
+void sky_store_cache_save(SkyStoreCache *cache, SkyStore *store, uint32_t first_key) {
+  int slot = store - cache->slots;
+  sky_store_save(store, first_key + slot*SKY_STORE_KEYS);
+}
+
+// The fields ahead of the grids, enough to place a store before reading it
+typedef struct SkyStoreHead {
+  uint16_t version;
+  uint16_t checksum;
+  int32_t start;
+  float latitude;
+  float longitude;
+} SkyStoreHead;
+_Static_assert(sizeof(SkyStoreHead) == offsetof(SkyStore, solar_elev_x100), "SkyStoreHead out of step");
+
+// Where a store taken is read before it replaces a slot, so one half
+// written or corrupt leaves the slot as it was
+static SkyStore s_taken;
+
+SkyStore *sky_store_cache_take(SkyStoreCache *cache, uint32_t first_key) {
+  SkyStoreHead head;
+  if ((persist_read_data(first_key, &head, sizeof(head)) != (int)sizeof(head)) ||
+      (head.version != SKY_STORE_VERSION))
+    return NULL;
+  int slot = prv_slot_for(cache, head.latitude, head.longitude);
+  SkyStore *store = &cache->slots[slot];
+  // the location's own store may be as new already
+  if ((store->version == SKY_STORE_VERSION) && prv_same_place(store, head.latitude, head.longitude) &&
+      (store->start >= head.start))
+    return NULL;
+  if (!sky_store_load(&s_taken, first_key))
+    return NULL;
+  prv_touch(cache, slot);
+  *store = s_taken;
+  return store;
+}
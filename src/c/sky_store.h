@@ -0,0 +1,97 @@
+#pragma once
+#include "sky_sdk.h"
+#include "ephemeris.h"
+#include "sky_path.h"
+//
+// Several days of hourly sun and moon elevations for one location, kept in
+// persistent storage so that a launch copies its tables instead of
+// computing them.  The tables redo_sky_paths() needs for any of the stored
+// days are slices of the two hourly grids below.  The lunar grid reaches 36
+// hours either side, as far as the lunar shift can move its table.
+//
+// A SkyStoreCache keeps stores for the last few locations, so going back
+// to a place seen recently (or asking about a second one) copies tables
+// instead of filling a new store.  Locations are told apart to
+// 1/SKY_STORE_STEPS_PER_DEGREE of a degree, well under the tables' own
+// accuracy.
+//
+
+// 2: topocentric moon from the lunar series
+#define SKY_STORE_VERSION 2
+#define SKY_STORE_DAYS 3
+#define SKY_STORE_SOLAR_ROWS (24*SKY_STORE_DAYS + 1)
+#define SKY_STORE_LUNAR_LEAD_HOURS 36
+#define SKY_STORE_LUNAR_ROWS (24*SKY_STORE_DAYS + 2*SKY_STORE_LUNAR_LEAD_HOURS + 24 + 1)
+
+typedef struct SkyStore {
+  uint16_t version;       // SKY_STORE_VERSION once filled or loaded, else 0
+  uint16_t checksum;      // Fletcher-16 of everything after it
+  int32_t start;          // midnight the first day starts at
+  float latitude;         // observer the grids belong to
+  float longitude;
+  int16_t solar_elev_x100[SKY_STORE_SOLAR_ROWS];  // hourly from start
+  int16_t lunar_elev_x100[SKY_STORE_LUNAR_ROWS];  // hourly from start - 36 hours
+} SkyStore;
+
+// Persistent storage keys the store takes, from its first key on
+#define SKY_STORE_KEYS ((sizeof(SkyStore) + PERSIST_DATA_MAX_LENGTH - 1) / PERSIST_DATA_MAX_LENGTH)
+
+// Compute SKY_STORE_DAYS days of grids from midnight
+void sky_store_fill(SkyStore *store, const Observer *obs, time_t midnight);
+
+// Copy the 25 row hourly table of body from start out of the store.  False
+// if the store is for another location or does not cover the table.
+bool sky_store_table(const SkyStore *store, const Observer *obs, SkyBody body,
+                     time_t start, int16_t *elev_x100);
+
+// Read the store from first_key on; false, leaving it empty, if it is
+// missing, of another version, or fails its checksum
+bool sky_store_load(SkyStore *store, uint32_t first_key);
+void sky_store_save(SkyStore *store, uint32_t first_key);
+
+#define SKY_STORE_STEPS_PER_DEGREE 10
+// each slot is a SkyStore in memory and SKY_STORE_KEYS keys of storage
+#ifdef PBL_PLATFORM_APLITE
+#define SKY_STORE_SLOTS 2
+#else
+#define SKY_STORE_SLOTS 3
+#endif
+
+typedef struct SkyStoreCache {
+  SkyStore slots[SKY_STORE_SLOTS];
+  uint32_t used[SKY_STORE_SLOTS];   // when each slot was last used, 0 never
+  uint32_t clock;                   // counts uses, for used[]
+  uint32_t hits;                    // sky_store_cache_get() found the tables
+  uint32_t misses;                  // and had to fill a store for them
+} SkyStoreCache;
+
+// Load every slot, from first_key on (SKY_STORE_KEYS keys each).  Slots
+// that fail to load are left empty.  The most recently filled is taken as
+// the most recently used.
+void sky_store_cache_load(SkyStoreCache *cache, uint32_t first_key);
+
+// The store holding obs's solar table from midnight and lunar table from
+// lunar_start, made the most recently used.  On a miss the location's own
+// slot, or else the least recently used one, is filled from midnight and
+// *filled set.
+SkyStore *sky_store_cache_get(SkyStoreCache *cache, const Observer *obs, time_t midnight,
+                              time_t lunar_start, bool *filled);
+
+// As sky_store_cache_get(), but on a miss nothing is filled and NULL is
+// returned, for when the tables are coming from elsewhere
+SkyStore *sky_store_cache_find(SkyStoreCache *cache, const Observer *obs, time_t midnight,
+                               time_t lunar_start);
+
+// Take a complete store made elsewhere (the phone's), into the slot of its
+// location or the least recently used one.  Returns where it went.
+SkyStore *sky_store_cache_put(SkyStoreCache *cache, const SkyStore *store);
+
+// Read a store saved at first_key on (the worker's) into the slot of its
+// location or the least recently used one, as sky_store_cache_put() does.
+// NULL if there is none, it fails to load, or the location's slot holds
+// one as new.  The store is read aside first, so a failed load leaves the
+// slot as it was.
+SkyStore *sky_store_cache_take(SkyStoreCache *cache, uint32_t first_key);
+
+// Write the slot holding store to its keys
+void sky_store_cache_save(SkyStoreCache *cache, SkyStore *store, uint32_t first_key);
@@ -0,0 +1,61 @@
+#include <pebble.h>
+#include "sky_worker.h"
+#include "profile.h"
+
+static int32_t prv_step(float degrees) {
+  return round_to_int(degrees * SKY_STORE_STEPS_PER_DEGREE);
+}
+
+bool sky_worker_place(const Observer *obs) {
+  if (!app_worker_is_running())
+    return false;
+  AppWorkerMessage message = {
+    .data0 = (uint16_t)(int16_t)prv_step(obs->Latitude),
+    .data1 = (uint16_t)(int16_t)prv_step(obs->Longitude),
+  };
+  app_worker_send_message(SKY_WORKER_MSG_PLACE, &message);
+  return true;
+}
+
+bool sky_worker_request(SkyWorker *worker, const Observer *obs) {
+  int32_t latitude_step = prv_step(obs->Latitude);
+  int32_t longitude_step = prv_step(obs->Longitude);
+  if (worker->pending && (latitude_step == worker->latitude_step) &&
+      (longitude_step == worker->longitude_step))
+    return true;
+  if (worker->fallback || !sky_worker_place(obs))
+    return false;
+
+  worker->pending = true;
+  worker->latitude_step = latitude_step;
+  worker->longitude_step = longitude_step;
+  worker->requests++;
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Asked worker for sky paths");
+  return true;
+}
+
+void sky_worker_timeout(SkyWorker *worker) {
+  if (!worker->pending)
+    return;
+  worker->pending = false;
+  worker->fallback = true;
+  APP_LOG(APP_LOG_LEVEL_WARNING, "Worker sky paths timed out");
+}
+
+SkyStore *sky_worker_receive(SkyWorker *worker, SkyStoreCache *cache) {
+  SkyStore *store = sky_store_cache_take(cache, SKY_WORKER_STORE_KEY);
+  if (store) {
+    worker->completed++;
+    worker->fallback = false;
+    // the worker's hourly refill may be for a location left since
+    if ((prv_step(store->latitude) == worker->latitude_step) &&
+        (prv_step(store->longitude) == worker->longitude_step))
+      worker->pending = false;
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "Sky paths from worker taken");
+  }
+  else if (worker->pending) {
+    worker->pending = false;
+    worker->fallback = true;
+  }
+  return store;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "sky_sdk.h"
+#include "ephemeris.h"
+#include "sky_store.h"
+//
+// Sky path grids from the background worker (worker_src/c/worker.c).  The
+// worker keeps a SkyStore for the face's location at SKY_WORKER_STORE_KEY
+// and fills it again, on its hourly tick, whenever it no longer covers
+// today and tomorrow, so the face takes the next days ready made instead
+// of computing them between frames.  Messages carry only the location, in
+// SkyStore place steps, and the word that the store is saved; the grids go
+// through persistent storage, which the app and its worker share.  The
+// worker only runs if the user turns on the BackgroundWorker setting.
+//
+// A cold start is still filled in the face, synchronously: with no tables
+// up yet there is nothing to show while the worker works, and the worker
+// may not even be running so early.  It only happens when no stored days,
+// the worker's included, cover today, so the first launch and a launch
+// after the worker was off.  Later misses go to the worker, with the old
+// tables up until it answers.
+//
+
+// Worker message types
+#define SKY_WORKER_MSG_STARTED 1  // worker to face: it needs the location
+#define SKY_WORKER_MSG_PLACE 2    // face to worker: latitude, longitude steps in data0, data1
+#define SKY_WORKER_MSG_READY 3    // worker to face: a store is saved at SKY_WORKER_STORE_KEY
+
+// The worker's store, clear of the face's own keys
+#define SKY_WORKER_STORE_KEY 16
+// A request with no store by then is filled by the face itself
+#define SKY_WORKER_TIMEOUT_MS 5000
+
+typedef struct SkyWorker {
+  bool pending;           // a request is out
+  bool fallback;          // the last request went unanswered: fill the next miss in the face
+  int32_t latitude_step;  // location asked for
+  int32_t longitude_step;
+  uint32_t requests;
+  uint32_t completed;
+} SkyWorker;
+
+// Tell the worker where the watch is.  False if it is not running.
+bool sky_worker_place(const Observer *obs);
+
+// Ask the worker for the grids of obs.  Returns true if a request is out,
+// this one or an earlier one for the same location, and false if the face
+// should fill them itself: no worker, or the last request fell back.
+bool sky_worker_request(SkyWorker *worker, const Observer *obs);
+
+// The request timed out; the face fills the next miss itself
+void sky_worker_timeout(SkyWorker *worker);
+
+// Take the worker's store into cache, on SKY_WORKER_MSG_READY or at launch.
+// Returns the store taken, or NULL if it was nothing new.  A store for the
+// location asked for answers a pending request; nothing new makes it fall
+// back.
+SkyStore *sky_worker_receive(SkyWorker *worker, SkyStoreCache *cache);
@@ -51,6 +51,16 @@ module.exports = [
         "type": "text",
         "defaultValue": "Tap on screen to advance information.  Cycles through Sun, Moon, MoonAge, and Location information"
       },
+      {
+        "type": "toggle",
+        "messageKey": "BackgroundWorker",
+        "label": "Compute sky paths in the background",
+        "defaultValue": false
+      },
+      {
+        "type": "text",
+        "defaultValue": "Uses the watch's one background app slot, so the face opens without computing.  If another app has the slot, the watch asks once before replacing it."
+      },
 //      {   // this slider is to tweak the time. Normally not used
 //        "type": "slider",
 //        "messageKey": "Dayshift",
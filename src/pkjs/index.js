@@ -2,6 +2,10 @@
 var Clay = require('pebble-clay');
 // Load our Clay configuration file
 var clayConfig = require('./config');
+// sky path tables computed for the watch
+var skyTables = require('./sky_tables');
+// the phone's position, sent when it moves
+var phoneLocation = require('./phone_location');
 // add location javascript function
 //var customClay = require('./location');
 //var clay = new Clay(clayConfig, customClay);
@@ -12,17 +16,24 @@ function cleanCoordinate(coord) {
   return (coord * 100)|0;
 }
 
+// Look for a new fix this often while the watchface runs
+var LOCATION_POLL_MS = 15 * 60 * 1000;
+var clay = null;
+
 function locationSuccess(pos) {
   var pos_data = 'Phone location: Latitude = ' + Number(pos.coords.latitude).toFixed(0) + ', Longitude = ' + Number(pos.coords.longitude).toFixed(0)
   console.log(pos_data);
   clayConfig[2].items[1].defaultValue = pos_data; // set up with the required value.
-  var clay = new Clay(clayConfig);
+  if (!clay) clay = new Clay(clayConfig);
+  phoneLocation.update(Pebble, localStorage, pos.coords, function(sent) {
+    console.log(sent ? 'Sent phone location' : 'Phone location not sent');
+  });
 }
 
 function locationError(err) {
   console.log('Error requesting location!');
   clayConfig[2].items[1].defaultValue = 'Failed to get location from phone'; // set up with the required value.
-  var clay = new Clay(clayConfig);
+  if (!clay) clay = new Clay(clayConfig);
 }
 
 function getLocation() {
@@ -38,7 +49,20 @@ Pebble.addEventListener('ready',
   function(e) {
     console.log('PebbleKit JS ready!');
 
-    // Get the initial weather
+    // Get the initial location, then keep an eye on it
     getLocation();
+    setInterval(getLocation, LOCATION_POLL_MS);
+  }
+);
+
+// The watch asks for sky path tables when its own are missing or running out
+Pebble.addEventListener('appmessage',
+  function(e) {
+    if (e.payload.SkyRequest !== undefined) {
+      console.log('Sending sky paths from ' + e.payload.SkyRequest);
+      skyTables.answerRequest(Pebble, e.payload, function(sent) {
+        console.log(sent ? 'Sent sky paths' : 'Failed to send sky paths');
+      });
+    }
   }
 );
@@ -0,0 +1,58 @@
+// Sends the phone's position to the watch, but only when it has moved far
+// enough for the watch to redo its sky paths (redo_sky_paths() in main.c
+// ignores less than half a degree).  The last position the watch took is
+// kept in localStorage, so a relaunch at the same place sends nothing.
+// One message carries both coordinates, in hundredths of a degree.
+
+var THRESHOLD_DEG = 0.5;
+var STORAGE_KEY = 'sentLocation';
+
+function lastSent(storage) {
+  var stored = storage.getItem(STORAGE_KEY);
+  return stored ? JSON.parse(stored) : null;
+}
+
+// Has latitude, longitude moved THRESHOLD_DEG or more from last?
+function hasMoved(last, latitude, longitude) {
+  if (!last) {
+    return true;
+  }
+  var dLon = Math.abs(longitude - last.longitude) % 360;
+  if (dLon > 180) {
+    dLon = 360 - dLon;  // across the date line
+  }
+  return (Math.abs(latitude - last.latitude) >= THRESHOLD_DEG) || (dLon >= THRESHOLD_DEG);
+}
+
+function buildMessage(latitude, longitude) {
+  return {
+    PhoneLatitude: Math.round(latitude * 100),
+    PhoneLongitude: Math.round(longitude * 100)
+  };
+}
+
+// Send coords (as from navigator.geolocation) through pebble if they moved.
+// done(true) if the watch took them, done(false) if nothing was sent or
+// the send failed, in which case the next fix tries again.
+function update(pebble, storage, coords, done) {
+  done = done || function() {};
+  if (!hasMoved(lastSent(storage), coords.latitude, coords.longitude)) {
+    done(false);
+    return;
+  }
+  pebble.sendAppMessage(buildMessage(coords.latitude, coords.longitude),
+    function() {
+      storage.setItem(STORAGE_KEY, JSON.stringify({ latitude: coords.latitude, longitude: coords.longitude }));
+      done(true);
+    },
+    function() {
+      done(false);
+    });
+}
+
+module.exports = {
+  THRESHOLD_DEG: THRESHOLD_DEG,
+  hasMoved: hasMoved,
+  buildMessage: buildMessage,
+  update: update
+};
@@ -0,0 +1,203 @@
+// Sky path grids for the watch, computed on the phone in double precision.
+// The model is the one the watch uses in ephemeris.c, with every row of the
+// lunar series in lunar_series.h rather than the watch's LUNAR_TERMS and
+// the exact parallax, so the phone's grids differ from the watch's by its
+// rounding, stepping and series truncation.
+// The layout follows SkyStore in sky_store.h and the messages SkyLink in
+// sky_link.h.
+
+var rad = Math.PI / 180;
+var e = rad * 23.4397; // obliquity of the Earth
+
+var J2000 = 946684800; // unix seconds, as in ephemeris.h
+var SECS_IN_HOUR = 3600;
+var SECS_IN_DAY = 86400;
+
+// as SKY_STORE_DAYS and SKY_STORE_LUNAR_LEAD_HOURS in sky_store.h
+var STORE_DAYS = 3;
+var LUNAR_LEAD_HOURS = 36;
+var SOLAR_ROWS = 24 * STORE_DAYS + 1;
+var LUNAR_ROWS = 24 * STORE_DAYS + 2 * LUNAR_LEAD_HOURS + 24 + 1;
+
+// as SKY_LINK_ROWS in sky_link.h
+var ROWS_PER_MESSAGE = 40;
+
+var SUN = 0;  // SKY_BODY_SUN
+var MOON = 1; // SKY_BODY_MOON
+
+function toDays(unixtime) {
+  return (unixtime - J2000) / SECS_IN_DAY - 0.5;
+}
+
+function rightAscension(l, b) {
+  return Math.atan2(Math.sin(l) * Math.cos(e) - Math.tan(b) * Math.sin(e), Math.cos(l));
+}
+
+function declination(l, b) {
+  return Math.asin(Math.sin(b) * Math.cos(e) + Math.cos(b) * Math.sin(e) * Math.sin(l));
+}
+
+function siderealTime(d, lw) {
+  return rad * (280.16 + 360.9856235 * d) - lw;
+}
+
+function altitude(H, phi, dec) {
+  return Math.asin(Math.sin(phi) * Math.sin(dec) + Math.cos(phi) * Math.cos(dec) * Math.cos(H));
+}
+
+function sunCoords(d) {
+  var M = rad * (357.5291 + 0.98560028 * d);
+  var C = rad * (1.9148 * Math.sin(M) + 0.02 * Math.sin(2 * M) + 0.0003 * Math.sin(3 * M));
+  var L = M + C + rad * 102.9372 + Math.PI;
+  return { dec: declination(L, 0), ra: rightAscension(L, 0) };
+}
+
+// Meeus tables 47.A and 47.B, as LUNAR_LONGITUDE_SERIES and
+// LUNAR_LATITUDE_SERIES in lunar_series.h: D, M, M', F, 1e-6 degrees, metres
+var LONGITUDE_SERIES = [
+  [0, 0, 1, 0, 6288774, -20905355], [2, 0, -1, 0, 1274027, -3699111],
+  [2, 0, 0, 0, 658314, -2955968], [0, 0, 2, 0, 213618, -569925],
+  [0, 1, 0, 0, -185116, 48888], [0, 0, 0, 2, -114332, -3149],
+  [2, 0, -2, 0, 58793, 246158], [2, -1, -1, 0, 57066, -152138],
+  [2, 0, 1, 0, 53322, -170733], [2, -1, 0, 0, 45758, -204586],
+  [0, 1, -1, 0, -40923, -129620], [1, 0, 0, 0, -34720, 108743],
+  [0, 1, 1, 0, -30383, 104755], [2, 0, 0, -2, 15327, 10321],
+  [0, 0, 1, 2, -12528, 0], [0, 0, 1, -2, 10980, 79661],
+  [4, 0, -1, 0, 10675, -34782], [0, 0, 3, 0, 10034, -23210],
+  [4, 0, -2, 0, 8548, -21636], [2, 1, -1, 0, -7888, 24208]
+];
+var LATITUDE_SERIES = [
+  [0, 0, 0, 1, 5128122], [0, 0, 1, 1, 280602], [0, 0, 1, -1, 277693],
+  [2, 0, 0, -1, 173237], [2, 0, -1, 1, 55413], [2, 0, -1, -1, 46271],
+  [2, 0, 0, 1, 32573], [0, 0, 2, 1, 17198], [2, 0, 1, -1, 9266],
+  [0, 0, 2, -1, 8822], [2, -1, 0, -1, 8216], [2, 0, -2, -1, 4324],
+  [2, 0, 1, 1, 4200], [2, 1, 0, -1, -3359], [2, -1, -1, 1, 2463],
+  [2, -1, 0, 1, 2211], [2, -1, -1, -1, 2065], [0, 1, -1, -1, -1870],
+  [4, 0, -1, -1, 1828], [0, 1, 0, 1, -1794]
+];
+
+function seriesArgument(row, D, M, Mp, F) {
+  return row[0] * D + row[1] * M + row[2] * Mp + row[3] * F;
+}
+
+function moonCoords(d) {
+  var L = rad * (218.316 + 13.176396 * d);     // mean longitude
+  var D = rad * (297.8502 + 12.19074912 * d);  // mean elongation
+  var M = rad * (357.5291 + 0.98560028 * d);   // sun's mean anomaly
+  var Mp = rad * (134.963 + 13.064993 * d);    // mean anomaly
+  var F = rad * (93.272 + 13.229350 * d);      // argument of latitude
+  var l = L, b = 0, distance = 385000560;      // metres
+  LONGITUDE_SERIES.forEach(function(row) {
+    var arg = seriesArgument(row, D, M, Mp, F);
+    l += rad * row[4] * 1e-6 * Math.sin(arg);
+    distance += row[5] * Math.cos(arg);
+  });
+  LATITUDE_SERIES.forEach(function(row) {
+    b += rad * row[4] * 1e-6 * Math.sin(seriesArgument(row, D, M, Mp, F));
+  });
+  return { dec: declination(l, b), ra: rightAscension(l, b), parallax: Math.asin(6378140 / distance) };
+}
+
+// Elevation of body in degrees
+function elevation(body, unixtime, latitude, longitude) {
+  var d = toDays(unixtime);
+  var c = (body === MOON) ? moonCoords(d) : sunCoords(d);
+  var H = siderealTime(d, rad * -longitude) - c.ra;
+  var h = altitude(H, rad * latitude, c.dec);
+  // the moon as seen from the surface, as moonPosition() on the watch
+  if (c.parallax) {
+    h -= c.parallax * Math.cos(h);
+  }
+  return h / rad;
+}
+
+// Hourly elevations x100 from start, truncated like angle_to_x100()
+function elevationGrid(body, start, rows, latitude, longitude) {
+  var grid = [];
+  for (var i = 0; i < rows; i++) {
+    grid.push((elevation(body, start + i * SECS_IN_HOUR, latitude, longitude) * 100) | 0);
+  }
+  return grid;
+}
+
+// int16 values as little-endian bytes
+function packRows(grid, first, count) {
+  var bytes = [];
+  for (var i = first; i < first + count; i++) {
+    var value = grid[i] & 0xffff;
+    bytes.push(value & 0xff, value >> 8);
+  }
+  return bytes;
+}
+
+// The messages answering a SkyRequest for midnight at latitude/longitude
+// (degrees): each body's grid in order, ROWS_PER_MESSAGE rows at a time
+function buildMessages(midnight, latitude, longitude) {
+  var grids = [
+    { body: SUN, grid: elevationGrid(SUN, midnight, SOLAR_ROWS, latitude, longitude) },
+    { body: MOON, grid: elevationGrid(MOON, midnight - LUNAR_LEAD_HOURS * SECS_IN_HOUR,
+                                      LUNAR_ROWS, latitude, longitude) }
+  ];
+  var messages = [];
+  grids.forEach(function(g) {
+    for (var row = 0; row < g.grid.length; row += ROWS_PER_MESSAGE) {
+      var count = Math.min(ROWS_PER_MESSAGE, g.grid.length - row);
+      messages.push({
+        SkyRequest: midnight,
+        SkyBody: g.body,
+        SkyRow: row,
+        SkyData: packRows(g.grid, row, count)
+      });
+    }
+  });
+  return messages;
+}
+
+// Send messages one after the other through pebble (the Pebble object),
+// retrying each a few times.  done(true) once all went, done(false) if one
+// never did.
+function sendMessages(pebble, messages, done) {
+  var index = 0;
+  var retries = 0;
+  function next() {
+    if (index >= messages.length) {
+      done(true);
+      return;
+    }
+    pebble.sendAppMessage(messages[index],
+      function() {
+        index++;
+        retries = 0;
+        next();
+      },
+      function() {
+        retries++;
+        if (retries > 3) {
+          done(false);
+          return;
+        }
+        next();
+      });
+  }
+  next();
+}
+
+// Answer a SkyRequest payload from the watch
+function answerRequest(pebble, payload, done) {
+  var messages = buildMessages(payload.SkyRequest, payload.SkyLatitude / 100, payload.SkyLongitude / 100);
+  sendMessages(pebble, messages, done || function() {});
+}
+
+module.exports = {
+  SUN: SUN,
+  MOON: MOON,
+  SOLAR_ROWS: SOLAR_ROWS,
+  LUNAR_ROWS: LUNAR_ROWS,
+  ROWS_PER_MESSAGE: ROWS_PER_MESSAGE,
+  LUNAR_LEAD_HOURS: LUNAR_LEAD_HOURS,
+  elevation: elevation,
+  elevationGrid: elevationGrid,
+  buildMessages: buildMessages,
+  sendMessages: sendMessages,
+  answerRequest: answerRequest
+};
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+#
+# Pack the sky sprites into the single atlas resource the watch loads.
+#
+# Run from the repository root after changing a sprite:
+#
+#   python3 tools/atlas/make_sky_atlas.py
+#
+# Reads the 8 bit RGBA PNGs next to this script and writes
+# resources/images/sky_atlas.png.  Only the standard library is used
+# (zlib for the PNG streams), so no imaging package is needed.  The
+# layout below must match SPRITE_RECTS in src/c/sky_atlas.c; the script
+# prints the rectangles to copy over if it changes.
+#
+
+import os
+import struct
+import zlib
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+OUTPUT = os.path.join(HERE, '..', '..', 'resources', 'images', 'sky_atlas.png')
+
+# name as in SkySprite, file, left edge in the atlas (all at the top)
+LAYOUT = [
+    ('SKY_SPRITE_SUN_RIM', 'sun_rim.png', 0),
+    ('SKY_SPRITE_SUN_RISEN', 'sun_risen.png', 15),
+    ('SKY_SPRITE_HORIZON', 'horizon.png', 30),
+]
+
+
+def read_png(path):
+    """Width, height and rows of RGBA bytes of an 8 bit RGBA PNG."""
+    data = open(path, 'rb').read()
+    assert data[:8] == b'\x89PNG\r\n\x1a\n', path
+    pos = 8
+    idat = b''
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        if kind == b'IHDR':
+            width, height, depth, color, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+            assert (depth, color, interlace) == (8, 6, 0), path + ': not 8 bit RGBA, non-interlaced'
+        elif kind == b'IDAT':
+            idat += chunk
+        pos += 12 + length
+
+    raw = zlib.decompress(idat)
+    stride = width * 4
+    rows = []
+    prev = bytearray(stride)
+    pos = 0
+    for _ in range(height):
+        kind = raw[pos]
+        line = bytearray(raw[pos + 1:pos + 1 + stride])
+        pos += 1 + stride
+        for i in range(stride):
+            a = line[i - 4] if i >= 4 else 0
+            b = prev[i]
+            c = prev[i - 4] if i >= 4 else 0
+            if kind == 1:
+                line[i] = (line[i] + a) & 0xff
+            elif kind == 2:
+                line[i] = (line[i] + b) & 0xff
+            elif kind == 3:
+                line[i] = (line[i] + (a + b) // 2) & 0xff
+            elif kind == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                line[i] = (line[i] + (a if pa <= pb and pa <= pc else b if pb <= pc else c)) & 0xff
+        rows.append(line)
+        prev = line
+    return width, height, rows
+
+
+def write_png(path, width, height, rows):
+    def chunk(kind, body):
+        return (struct.pack('>I', len(body)) + kind + body +
+                struct.pack('>I', zlib.crc32(kind + body) & 0xffffffff))
+    raw = b''.join(b'\x00' + bytes(row) for row in rows)
+    with open(path, 'wb') as out:
+        out.write(b'\x89PNG\r\n\x1a\n')
+        out.write(chunk(b'IHDR', struct.pack('>IIBBBBB', width, height, 8, 6, 0, 0, 0)))
+        out.write(chunk(b'IDAT', zlib.compress(raw, 9)))
+        out.write(chunk(b'IEND', b''))
+
+
+def main():
+    sprites = [(name, left) + read_png(os.path.join(HERE, filename)) for name, filename, left in LAYOUT]
+    width = max(left + w for _, left, w, _, _ in sprites)
+    height = max(h for _, _, _, h, _ in sprites)
+    atlas = [bytearray(width * 4) for _ in range(height)]
+    for name, left, w, h, rows in sprites:
+        for y in range(h):
+            atlas[y][left * 4:(left + w) * 4] = rows[y]
+        print('  [%s] = { { %d, 0 }, { %d, %d } },' % (name, left, w, h))
+    write_png(OUTPUT, width, height, atlas)
+    print('wrote %s, %d x %d' % (os.path.normpath(OUTPUT), width, height))
+
+
+if __name__ == '__main__':
+    main()
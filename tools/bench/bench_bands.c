@@ -0,0 +1,90 @@
+//
+// Twilight bands: span table size, build and draw cost, and accuracy, on the host.
+//
+// Build and run from the repository root:
+//
+//   cc -O2 -I tools/host -I src/c -o bench_bands tools/bench/bench_bands.c src/c/sky_bands.c src/c/sky_layout.c src/c/sky_path.c src/c/ephemeris.c src/c/ephemeris_fixed.c tools/host/pebble_host.c -lm
+//   ./bench_bands
+//
+// For every day of a year and a few latitudes the bands of a 144 x 67
+// canvas are built from the hourly solar table and drawn.  The report
+// gives the spans per day, the host time of a build, the fill calls and
+// pixels per frame, and the share of columns whose band differs from the
+// one the sun's computed position at the middle of the column gives.
+// Classing each column from sunPositionFixed() instead would take about
+// 11 lookups a column, 1584 a build.
+//
+#include <pebble.h>
+#include "ephemeris.h"
+#include "sky_path.h"
+#include "sky_bands.h"
+
+#define YEAR_START 1704067200  // 2024-01-01 00:00:00 UTC
+#define DAYS 366
+#define WIDTH 144
+#define HEIGHT 67
+
+static const int16_t s_floors_x100[SKY_BAND_NIGHT] = { -83, -600, -1200, -1800 };
+
+static double prv_now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int prv_band(int32_t elev_x100) {
+  int band = SKY_BAND_DAY;
+  while ((band < SKY_BAND_NIGHT) && (elev_x100 < s_floors_x100[band]))
+    band++;
+  return band;
+}
+
+static void prv_run(float latitude, float longitude) {
+  Observer obs;
+  observer_init(&obs, latitude, longitude);
+  static SkyLayout layout;
+  layout.latitude = latitude;
+  sky_layout_init(&layout, WIDTH, HEIGHT, false);
+  SkyBands bands = { 0 };
+  time_t zone = (time_t)(-longitude/15) * SECS_IN_HOUR;
+  long spans = 0, wrong = 0;
+  int max_spans = 0;
+  uint32_t calls = 0, pixels = 0;
+  double build_ns = 0;
+
+  for (int day = 0; day < DAYS; day++) {
+    time_t midnight = YEAR_START + (time_t)day * SECS_IN_DAY + zone;
+    int16_t table[25];
+    sky_path_fill(SKY_BODY_SUN, &obs, midnight, 25, SECS_IN_HOUR, table);
+
+    double start = prv_now_ns();
+    sky_bands_build(&bands, &layout, table);
+    build_ns += prv_now_ns() - start;
+    spans += bands.count;
+    if (bands.count > max_spans) max_spans = bands.count;
+
+    uint32_t calls_before = pebble_host_draw_calls, pixels_before = pebble_host_pixels_drawn;
+    sky_bands_draw(&bands, NULL, &layout);
+    calls += pebble_host_draw_calls - calls_before;
+    pixels += pebble_host_pixels_drawn - pixels_before;
+
+    for (int i = 0; i < bands.count; i++) {
+      for (int x = bands.spans[i].start; x <= bands.spans[i].end; x++) {
+        int32_t azi, alt;
+        sunPositionFixed(&obs, midnight + (time_t)(2*x + 1) * SECS_IN_DAY / (2*WIDTH), NO_AZI, &azi, &alt);
+        if (prv_band(angle_to_x100(alt)) != bands.spans[i].band) wrong++;
+      }
+    }
+  }
+  printf("lat %6.1f  %4.1f spans/day (max %2d)  %5.0f ns/build  %4.1f fills %6.0f pixels/frame  "
+         "%.2f%% of columns in another band\n", latitude, (double)spans / DAYS, max_spans,
+         build_ns / DAYS, (double)calls / DAYS, (double)pixels / DAYS, 100.0 * wrong / (DAYS * WIDTH));
+}
+
+int main(void) {
+  const float latitudes[] = { 78.0f, 64.8f, 45.0f, 0.0f, -33.9f };
+  const float longitudes[] = { 15.6f, -147.0f, 7.0f, 0.0f, 151.2f };
+  for (unsigned i = 0; i < sizeof(latitudes)/sizeof(latitudes[0]); i++)
+    prv_run(latitudes[i], longitudes[i]);
+  return 0;
+}
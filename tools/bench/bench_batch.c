@@ -0,0 +1,127 @@
+//
+// Batched positions against the scalar loop, on the host.
+//
+// Build and run from the repository root:
+//
+//   cc -O2 -I tools/host -I src/c -o bench_batch tools/bench/bench_batch.c src/c/sky_path.c src/c/ephemeris.c src/c/ephemeris_fixed.c tools/host/pebble_host.c -lm
+//   ./bench_batch
+//
+// For a few run shapes (a day of hours, an hour of minutes, a day of
+// minutes), each run is computed once with a loop of sunPositionFixed() or
+// moonPositionFixed() and once with sunPositionBatch()/moonPositionBatch(),
+// with and without azimuth, starting every fifth day of a year.  The report
+// gives lookups and host time per point both ways, and the largest
+// difference of the batch from the scalar kernel.  Azimuth is only compared
+// above -45 degrees, where it is not dominated by the rounding near nadir.
+//
+#include <pebble.h>
+#include <stdlib.h>
+#include "ephemeris.h"
+#include "sky_path.h"
+
+#define YEAR_START 1704067200  // 2024-01-01 00:00:00 UTC
+#define DAYS 366
+#define DAY_STEP 5
+#define MAX_POINTS 1441
+
+typedef struct RunShape {
+  const char *name;
+  int32_t step_secs;
+  int count;
+} RunShape;
+
+static const RunShape s_shapes[] = {
+  { "day of hours", SECS_IN_HOUR, 25 },
+  { "hour of minutes", 60, 61 },
+  { "day of minutes", 60, 1441 },
+};
+
+static int32_t s_azi[MAX_POINTS], s_alt[MAX_POINTS];
+static int32_t s_ref_azi[MAX_POINTS], s_ref_alt[MAX_POINTS];
+
+static double prv_now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void prv_scalar(SkyBody body, const Observer *obs, time_t start, const RunShape *shape, int calc_azi) {
+  for (int i = 0; i < shape->count; i++) {
+    time_t t = start + (time_t)i * shape->step_secs;
+    if (body == SKY_BODY_SUN)
+      sunPositionFixed(obs, t, calc_azi, &s_ref_azi[i], &s_ref_alt[i]);
+    else
+      moonPositionFixed(obs, t, calc_azi, &s_ref_azi[i], &s_ref_alt[i]);
+  }
+}
+
+static void prv_batch(SkyBody body, const Observer *obs, time_t start, const RunShape *shape, int calc_azi) {
+  int32_t *azi = (calc_azi == CALC_AZI) ? s_azi : NULL;
+  if (body == SKY_BODY_SUN)
+    sunPositionBatch(obs, start, shape->step_secs, shape->count, azi, s_alt);
+  else
+    moonPositionBatch(obs, start, shape->step_secs, shape->count, azi, s_alt);
+}
+
+// lookups and best host time per point of one way over the year
+static void prv_cost(bool batch, SkyBody body, const Observer *obs, const RunShape *shape, int calc_azi,
+                     double *lookups, double *ns) {
+  double best = 1e30;
+  uint32_t used = 0;
+  int runs = 0;
+  for (int pass = 0; pass < 5; pass++) {
+    uint32_t start_lookups = pebble_host_trig_lookups;
+    double start = prv_now_ns();
+    runs = 0;
+    for (int day = 0; day < DAYS; day += DAY_STEP, runs++) {
+      time_t t = YEAR_START + (time_t)day * SECS_IN_DAY;
+      if (batch)
+        prv_batch(body, obs, t, shape, calc_azi);
+      else
+        prv_scalar(body, obs, t, shape, calc_azi);
+    }
+    double elapsed = prv_now_ns() - start;
+    if (elapsed < best) best = elapsed;
+    used = pebble_host_trig_lookups - start_lookups;
+  }
+  *lookups = (double)used / (runs * shape->count);
+  *ns = best / (runs * shape->count);
+}
+
+static void prv_run(SkyBody body, const Observer *obs, const RunShape *shape, int calc_azi) {
+  double scalar_lookups, scalar_ns, batch_lookups, batch_ns;
+  prv_cost(false, body, obs, shape, calc_azi, &scalar_lookups, &scalar_ns);
+  prv_cost(true, body, obs, shape, calc_azi, &batch_lookups, &batch_ns);
+
+  int32_t max_alt = 0, max_azi = 0;
+  for (int day = 0; day < DAYS; day += DAY_STEP) {
+    time_t t = YEAR_START + (time_t)day * SECS_IN_DAY;
+    prv_scalar(body, obs, t, shape, calc_azi);
+    prv_batch(body, obs, t, shape, calc_azi);
+    for (int i = 0; i < shape->count; i++) {
+      int32_t err = abs(s_alt[i] - s_ref_alt[i]);
+      if (err > max_alt) max_alt = err;
+      if ((calc_azi == CALC_AZI) && (s_ref_alt[i] > -TRIG_MAX_ANGLE/8)) {
+        err = abs((int16_t)(s_azi[i] - s_ref_azi[i]));
+        if (err > max_azi) max_azi = err;
+      }
+    }
+  }
+  printf("%-5s %-16s %-4s scalar %5.1f lookups %6.0f ns  batch %5.2f lookups %5.0f ns/point  "
+         "max err alt %.3f azi %.3f deg\n",
+         body == SKY_BODY_SUN ? "sun" : "moon", shape->name, calc_azi == CALC_AZI ? "+azi" : "",
+         scalar_lookups, scalar_ns, batch_lookups, batch_ns,
+         max_alt * 360.0 / TRIG_MAX_ANGLE, max_azi * 360.0 / TRIG_MAX_ANGLE);
+}
+
+int main(void) {
+  Observer obs;
+  observer_init(&obs, 45.0, 7.0);
+  for (unsigned s = 0; s < sizeof(s_shapes)/sizeof(s_shapes[0]); s++) {
+    for (int body = SKY_BODY_SUN; body <= SKY_BODY_MOON; body++) {
+      prv_run(body, &obs, &s_shapes[s], NO_AZI);
+      prv_run(body, &obs, &s_shapes[s], CALC_AZI);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,337 @@
+//
+// Micro-benchmark for the ephemeris core, run on the host.
+//
+// Build and run from the repository root:
+//
+//   cc -O2 -I tools/host -I src/c -o bench_ephemeris tools/bench/bench_ephemeris.c src/c/ephemeris.c src/c/ephemeris_fixed.c tools/host/pebble_host.c -lm
+//   ./bench_ephemeris
+//
+// Every function is evaluated over one year of timestamps at ten minute
+// steps and the time per call is reported, along with the number of
+// sin/cos/atan2 lookups per call, which does not depend on the host.  Absolute numbers are for the
+// host CPU; use them to compare variants, not to predict watch timings.
+// The host has an FPU, so the gap between the float and integer kernels
+// understates what the watch sees with soft-float.
+//
+#include <pebble.h>
+#include <stdlib.h>
+#include <math.h>
+#include "ephemeris.h"
+#include "lunar_series.h"
+
+#define YEAR_START 1704067200  // 2024-01-01 00:00:00 UTC
+#define YEAR_STEP_SECS 600
+#define YEAR_SAMPLES (366 * SECS_IN_DAY / YEAR_STEP_SECS)
+#define PASSES 15
+
+static Observer s_observer;
+static volatile float s_sink;
+
+typedef void (*BenchFn)(time_t unixdate);
+
+static double prv_now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void bench_sun_position(time_t t) {
+  float azi, alt;
+  sunPosition(&s_observer, t, NO_AZI, &azi, &alt);
+  s_sink = alt;
+}
+
+static void bench_sun_position_azi(time_t t) {
+  float azi, alt;
+  sunPosition(&s_observer, t, CALC_AZI, &azi, &alt);
+  s_sink = alt + azi;
+}
+
+static void bench_moon_position(time_t t) {
+  float azi, alt;
+  moonPosition(&s_observer, t, NO_AZI, &azi, &alt);
+  s_sink = alt;
+}
+
+static void bench_moon_position_azi(time_t t) {
+  float azi, alt;
+  moonPosition(&s_observer, t, CALC_AZI, &azi, &alt);
+  s_sink = alt + azi;
+}
+
+static void bench_sun_position_float(time_t t) {
+  float azi, alt;
+  sunPositionFloat(&s_observer, t, CALC_AZI, &azi, &alt);
+  s_sink = alt + azi;
+}
+
+static void bench_sun_position_fixed(time_t t) {
+  int32_t azi, alt;
+  sunPositionFixed(&s_observer, t, CALC_AZI, &azi, &alt);
+  s_sink = alt + azi;
+}
+
+static void bench_moon_position_float(time_t t) {
+  float azi, alt;
+  moonPositionFloat(&s_observer, t, CALC_AZI, &azi, &alt);
+  s_sink = alt + azi;
+}
+
+static void bench_moon_position_fixed(time_t t) {
+  int32_t azi, alt;
+  moonPositionFixed(&s_observer, t, CALC_AZI, &azi, &alt);
+  s_sink = alt + azi;
+}
+
+static void bench_sun_coords(time_t t) {
+  float dec, ra;
+  sunCoords(toDays(t), &dec, &ra);
+  s_sink = dec + ra;
+}
+
+static void bench_moon_coords(time_t t) {
+  float dec, ra, parallax;
+  moonCoords(toDays(t), &ra, &dec, &parallax);
+  s_sink = dec + ra + parallax;
+}
+
+static void bench_sidereal_time(time_t t) {
+  s_sink = siderealTime(toDays(t), DEG2RAD * 147);
+}
+
+static void bench_moon_phase(time_t t) {
+  s_sink = moonPhase(t);
+}
+
+static void bench_sin_pebble(time_t t) {
+  s_sink = sin_pebble((float)(t % 3600) * 0.001745);
+}
+
+static void bench_cos_pebble(time_t t) {
+  s_sink = cos_pebble((float)(t % 3600) * 0.001745);
+}
+
+static void bench_atan2_pebble(time_t t) {
+  float a = (float)(t % 3600) * 0.001745;
+  s_sink = atan2_pebble(sin_pebble(a), 0.5);
+}
+
+static void prv_run(const char *name, BenchFn fn) {
+  // warm up once so table construction is not timed
+  fn(YEAR_START);
+  // best pass wins, which keeps scheduler noise out of the comparison
+  double ns_per_call = 1e30;
+  for (int pass = 0; pass < PASSES; pass++) {
+    double start = prv_now_ns();
+    time_t t = YEAR_START;
+    for (int i = 0; i < YEAR_SAMPLES; i++) {
+      fn(t);
+      t += YEAR_STEP_SECS;
+    }
+    double pass_ns = (prv_now_ns() - start) / YEAR_SAMPLES;
+    if (pass_ns < ns_per_call) ns_per_call = pass_ns;
+  }
+  uint32_t lookups = pebble_host_trig_lookups;
+  fn(YEAR_START);
+  lookups = pebble_host_trig_lookups - lookups;
+  printf("%-24s %8.1f ns/call %12.0f calls/s %4u lookups\n", name, ns_per_call, 1e9 / ns_per_call,
+         (unsigned)lookups);
+}
+
+static double prv_wrap_degrees(double diff) {
+  while (diff > 180) diff -= 360;
+  while (diff < -180) diff += 360;
+  return diff;
+}
+
+// Double precision evaluation of the same model, used as the
+// reference for both kernels.
+static double prv_ref_asin(double x) {
+  return asin(x);
+}
+
+typedef struct RefTerm {
+  int D, M, Mp, F;
+  double micro, metres;
+} RefTerm;
+#define REF_TERM(D, M, Mp, F, micro, metres) { D, M, Mp, F, micro, metres },
+static const RefTerm s_ref_longitude[] = { LUNAR_LONGITUDE_SERIES(REF_TERM) };
+static const RefTerm s_ref_latitude[] = { LUNAR_LATITUDE_SERIES(REF_TERM) };
+
+static double prv_ref_argument(const RefTerm *term, double d) {
+  double rad = M_PI / 180;
+  return rad * (term->D * (LUNAR_D_BASE + LUNAR_D_RATE * d) + term->M * (LUNAR_M_BASE + LUNAR_M_RATE * d) +
+                term->Mp * (LUNAR_MP_BASE + LUNAR_MP_RATE * d) + term->F * (LUNAR_F_BASE + LUNAR_F_RATE * d));
+}
+
+static void prv_ref_position(bool moon, double latitude, double longitude, time_t t,
+                             double *azi, double *alt) {
+  double rad = M_PI / 180, e = rad * TILT_OF_EARTH;
+  double d = (double)(t - J2000) / SECS_IN_DAY - 0.5;
+  double l, b = 0, parallax = 0;
+  if (moon) {
+    // the kernels' LUNAR_TERMS rows
+    l = rad * (LUNAR_L_BASE + LUNAR_L_RATE * d);
+    parallax = rad * LUNAR_PARALLAX_MEAN;
+    for (int i = 0; i < LUNAR_TERMS; i++) {
+      double arg = prv_ref_argument(&s_ref_longitude[i], d);
+      l += rad * LUNAR_DEGREES_OF(s_ref_longitude[i].micro) * sin(arg);
+      if (i < LUNAR_PARALLAX_TERMS)
+        parallax += rad * LUNAR_PARALLAX_OF(s_ref_longitude[i].metres) * cos(arg);
+      b += rad * LUNAR_DEGREES_OF(s_ref_latitude[i].micro) * sin(prv_ref_argument(&s_ref_latitude[i], d));
+    }
+  }
+  else {
+    double M = rad * (357.5291 + 0.98560028 * d);
+    l = M + rad * (1.9148 * sin(M) + 0.02 * sin(2 * M) + 0.0003 * sin(3 * M)) + rad * 102.9372 + M_PI;
+  }
+  double ra = atan2(sin(l) * cos(e) - tan(b) * sin(e), cos(l));
+  double dec = prv_ref_asin(sin(b) * cos(e) + cos(b) * sin(e) * sin(l));
+  double phi = rad * latitude;
+  double H = rad * (280.16 + 360.9856235 * d) + rad * longitude - ra;
+  double sin_alt = sin(phi) * sin(dec) + cos(phi) * cos(dec) * cos(H);
+  *alt = prv_ref_asin(sin_alt);
+  *alt = (*alt - parallax * cos(*alt)) / rad;
+  *azi = atan2(sin(H), cos(H) * sin(phi) - tan(dec) * cos(phi)) / rad + 180;
+  // azimuth is meaningless right at the zenith
+  if (fabs(sin_alt) > 0.99) *azi = NAN;
+}
+
+typedef struct KernelError {
+  double alt;
+  double azi;
+} KernelError;
+
+static void prv_track_error(KernelError *err, double ref_azi, double ref_alt, double azi, double alt) {
+  if (fabs(alt - ref_alt) > err->alt) err->alt = fabs(alt - ref_alt);
+  if (!isnan(ref_azi) && fabs(prv_wrap_degrees(azi - ref_azi)) > err->azi)
+    err->azi = fabs(prv_wrap_degrees(azi - ref_azi));
+}
+
+// largest error of each kernel against the double precision model over the year
+static void prv_compare_kernels(float latitude, float longitude) {
+  Observer obs;
+  observer_init(&obs, latitude, longitude);
+  KernelError sun_float = {0}, sun_fixed = {0}, moon_float = {0}, moon_fixed = {0};
+  const double to_degrees = 360.0 / TRIG_MAX_ANGLE;
+  time_t t = YEAR_START;
+  for (int i = 0; i < YEAR_SAMPLES; i++) {
+    double ref_azi, ref_alt;
+    float azi, alt;
+    int32_t azi_fixed, alt_fixed;
+    prv_ref_position(false, latitude, longitude, t, &ref_azi, &ref_alt);
+    sunPositionFloat(&obs, t, CALC_AZI, &azi, &alt);
+    prv_track_error(&sun_float, ref_azi, ref_alt, azi, alt);
+    sunPositionFixed(&obs, t, CALC_AZI, &azi_fixed, &alt_fixed);
+    prv_track_error(&sun_fixed, ref_azi, ref_alt, azi_fixed * to_degrees, alt_fixed * to_degrees);
+    prv_ref_position(true, latitude, longitude, t, &ref_azi, &ref_alt);
+    moonPositionFloat(&obs, t, CALC_AZI, &azi, &alt);
+    prv_track_error(&moon_float, ref_azi, ref_alt, azi, alt);
+    moonPositionFixed(&obs, t, CALC_AZI, &azi_fixed, &alt_fixed);
+    prv_track_error(&moon_fixed, ref_azi, ref_alt, azi_fixed * to_degrees, alt_fixed * to_degrees);
+    t += YEAR_STEP_SECS;
+  }
+  printf("lat %6.1f lon %7.1f  sun float %.3f/%.3f fixed %.3f/%.3f"
+         "  moon float %.3f/%.3f fixed %.3f/%.3f\n", latitude, longitude,
+         sun_float.alt, sun_float.azi, sun_fixed.alt, sun_fixed.azi,
+         moon_float.alt, moon_float.azi, moon_fixed.alt, moon_fixed.azi);
+}
+
+// Inverse trig: error against libm and cost per call.  The small angle
+// asin and the int16 clamped atan2 are the versions this replaced.
+
+#define INV_TRIG_SAMPLES 20001
+
+static float prv_asin_small_angle(float ratio) {
+  return ratio;
+}
+
+static float prv_atan2_clamped(float y, float x) {
+  int16_t y_pebble = (int16_t) (8192 * y );
+  int16_t x_pebble = (int16_t) (8192 * x );
+  return (2*PI * (float)atan2_lookup(y_pebble, x_pebble) / (float)TRIG_MAX_ANGLE);
+}
+
+static float s_ratio[INV_TRIG_SAMPLES];
+static float s_y[INV_TRIG_SAMPLES], s_x[INV_TRIG_SAMPLES];
+
+static void prv_inv_trig_inputs() {
+  for (int i = 0; i < INV_TRIG_SAMPLES; i++) {
+    s_ratio[i] = -1.0f + 2.0f * i / (INV_TRIG_SAMPLES - 1);
+    // points around the circle at radii from 0.25 to 4
+    double a = 2 * M_PI * i / INV_TRIG_SAMPLES;
+    double r = 0.25 + 3.75 * (i % 16) / 15.0;
+    s_y[i] = r * sin(a);
+    s_x[i] = r * cos(a);
+  }
+}
+
+static double prv_angle_error(double a, double b) {
+  double diff = fmod(a - b, 2 * M_PI);
+  if (diff > M_PI) diff -= 2 * M_PI;
+  if (diff < -M_PI) diff += 2 * M_PI;
+  return fabs(diff) * 180 / M_PI;
+}
+
+static double prv_inv_trig_eval(int which, int i) {
+  switch (which) {
+    case 0: return prv_asin_small_angle(s_ratio[i]);
+    case 1: return asin_pebble(s_ratio[i]);
+    case 2: return asin_angle((int32_t)(s_ratio[i] * 32768)) * 2 * M_PI / TRIG_MAX_ANGLE;
+    case 3: return prv_atan2_clamped(s_y[i], s_x[i]);
+    case 4: return atan2_pebble(s_y[i], s_x[i]);
+    default: return atan2_lookup((int16_t)(s_y[i] * 8192), (int16_t)(s_x[i] * 8192)) * 2 * M_PI / TRIG_MAX_ANGLE;
+  }
+}
+
+static void prv_inv_trig_table() {
+  static const char *names[] = {
+    "asin small angle (old)", "asin_pebble", "asin_angle (Q15)",
+    "atan2 int16 clamp (old)", "atan2_pebble", "atan2_lookup (Q13)" };
+  prv_inv_trig_inputs();
+  printf("\n%-24s %12s %12s\n", "inverse trig", "max err deg", "ns/call");
+  for (int which = 0; which < 6; which++) {
+    double max_err = 0;
+    for (int i = 0; i < INV_TRIG_SAMPLES; i++) {
+      double exact = (which < 3) ? asin(s_ratio[i]) : atan2(s_y[i], s_x[i]);
+      double err = prv_angle_error(prv_inv_trig_eval(which, i), exact);
+      if (err > max_err) max_err = err;
+    }
+    double start = prv_now_ns();
+    for (int pass = 0; pass < 100; pass++)
+      for (int i = 0; i < INV_TRIG_SAMPLES; i++)
+        s_sink = prv_inv_trig_eval(which, i);
+    double ns_per_call = (prv_now_ns() - start) / (100.0 * INV_TRIG_SAMPLES);
+    printf("%-24s %12.4f %12.1f\n", names[which], max_err, ns_per_call);
+  }
+}
+
+int main(void) {
+  observer_init(&s_observer, 64.8, -147);
+  printf("%d timestamps x %d passes, observer %.1f,%.1f\n",
+         YEAR_SAMPLES, PASSES, s_observer.Latitude, s_observer.Longitude);
+  prv_run("sunPosition", bench_sun_position);
+  prv_run("sunPosition+azi", bench_sun_position_azi);
+  prv_run("moonPosition", bench_moon_position);
+  prv_run("moonPosition+azi", bench_moon_position_azi);
+  prv_run("sunPositionFloat+azi", bench_sun_position_float);
+  prv_run("sunPositionFixed+azi", bench_sun_position_fixed);
+  prv_run("moonPositionFloat+azi", bench_moon_position_float);
+  prv_run("moonPositionFixed+azi", bench_moon_position_fixed);
+  prv_run("sunCoords", bench_sun_coords);
+  prv_run("moonCoords", bench_moon_coords);
+  prv_run("siderealTime", bench_sidereal_time);
+  prv_run("moonPhase", bench_moon_phase);
+  prv_run("sin_pebble", bench_sin_pebble);
+  prv_run("cos_pebble", bench_cos_pebble);
+  prv_run("atan2_pebble", bench_atan2_pebble);
+
+  printf("\nmax error vs double precision over the year, alt/azi in degrees:\n");
+  prv_compare_kernels(64.8, -147);
+  prv_compare_kernels(45, 7);
+  prv_compare_kernels(0, 0);
+  prv_compare_kernels(-33.9, 151.2);
+
+  prv_inv_trig_table();
+  return 0;
+}
@@ -0,0 +1,137 @@
+//
+// Rise/set/noon/twilight solver: evaluations per event and accuracy, on the host.
+//
+// Build and run from the repository root:
+//
+//   cc -O2 -I tools/host -I src/c -o bench_events tools/bench/bench_events.c src/c/sky_events.c src/c/sky_path.c src/c/ephemeris.c src/c/ephemeris_fixed.c tools/host/pebble_host.c -lm
+//   ./bench_events
+//
+// For every day of a year and a few latitudes the events are solved from
+// the hourly tables, then found again by scanning the same position model
+// minute by minute and bisecting to the second; noon against a double
+// precision hour angle.  The report gives the
+// sunPosition/moonPosition calls per solved event, the worst and mean
+// timing difference, and days where only one of the two found the event.
+//
+#include <pebble.h>
+#include <stdlib.h>
+#include <math.h>
+#include "ephemeris.h"
+#include "sky_path.h"
+#include "sky_events.h"
+
+#define YEAR_START 1704067200  // 2024-01-01 00:00:00 UTC
+#define DAYS 366
+
+static const char *s_names[SKY_EVENT_COUNT] = {
+  "sunrise", "sunset", "solar noon", "civil dawn", "civil dusk",
+  "nautical dawn", "nautical dusk", "moonrise", "moonset"
+};
+static const float s_alts[SKY_EVENT_COUNT] = {
+  -0.833f, -0.833f, 0, -6, -6, -12, -12, -0.825f, -0.825f
+};
+
+static float prv_alt(bool moon, const Observer *obs, time_t t) {
+  float azi, alt;
+  if (moon)
+    moonPosition(obs, t, NO_AZI, &azi, &alt);
+  else
+    sunPosition(obs, t, NO_AZI, &azi, &alt);
+  return alt;
+}
+
+// first crossing of alt in the day by scanning each minute, then bisecting
+static time_t prv_scan_crossing(bool moon, const Observer *obs, time_t midnight, float alt, bool rising) {
+  float prev = prv_alt(moon, obs, midnight) - alt;
+  for (int m = 1; m <= 24*60; m++) {
+    time_t t = midnight + m*60;
+    float f = prv_alt(moon, obs, t) - alt;
+    if (rising ? ((prev < 0) && (f >= 0)) : ((prev >= 0) && (f < 0))) {
+      time_t lo = t - 60, hi = t;
+      while (hi - lo > 1) {
+        time_t mid = (lo + hi)/2;
+        float fm = prv_alt(moon, obs, mid) - alt;
+        if ((fm >= 0) == rising) hi = mid; else lo = mid;
+      }
+      return hi;
+    }
+    prev = f;
+  }
+  return SKY_EVENT_NONE;
+}
+
+// The sun's hour angle in double precision, the suncalc model both kernels follow
+static double prv_hour_angle(double longitude, time_t t) {
+  double rad = M_PI / 180;
+  double d = (double)t / SECS_IN_DAY - 0.5 + 2440588 - 2451545;
+  double M = rad * (357.5291 + 0.98560028 * d);
+  double C = rad * (1.9148 * sin(M) + 0.02 * sin(2 * M) + 0.0003 * sin(3 * M));
+  double L = M + C + rad * 102.9372 + M_PI;
+  double ra = atan2(sin(L) * cos(rad * 23.4397), cos(L));
+  double H = rad * (280.16 + 360.9856235 * d) + rad * longitude - ra;
+  return remainder(H, 2 * M_PI);
+}
+
+// Noon where the hour angle changes sign, bisected to the second
+static time_t prv_scan_noon(float longitude, time_t midnight) {
+  for (int m = 1; m <= 24*60; m++) {
+    time_t lo = midnight + (m - 1)*60, hi = midnight + m*60;
+    if ((prv_hour_angle(longitude, lo) < 0) && (prv_hour_angle(longitude, hi) >= 0)) {
+      while (hi - lo > 1) {
+        time_t mid = (lo + hi)/2;
+        if (prv_hour_angle(longitude, mid) >= 0) hi = mid; else lo = mid;
+      }
+      return hi;
+    }
+  }
+  return SKY_EVENT_NONE;
+}
+
+static void prv_run(float latitude, float longitude) {
+  Observer obs;
+  observer_init(&obs, latitude, longitude);
+  SkyEvents events = { 0 };
+  time_t zone = (time_t)(-longitude/15) * SECS_IN_HOUR;
+  long evaluations = 0, solved = 0;
+  long max_err[SKY_EVENT_COUNT] = { 0 }, sum_err[SKY_EVENT_COUNT] = { 0 };
+  int count[SKY_EVENT_COUNT] = { 0 }, mismatch[SKY_EVENT_COUNT] = { 0 };
+
+  for (int day = 0; day < DAYS; day++) {
+    time_t midnight = YEAR_START + (time_t)day * SECS_IN_DAY + zone;
+    sky_events_update(&events, &obs, midnight, NULL, 0);
+    evaluations += events.evaluations;
+    solved += events.solved;
+    for (int e = 0; e < SKY_EVENT_COUNT; e++) {
+      time_t ref;
+      if (e == SKY_EVENT_SOLAR_NOON)
+        ref = prv_scan_noon(longitude, midnight);
+      else
+        ref = prv_scan_crossing(e >= SKY_EVENT_MOONRISE, &obs, midnight, s_alts[e],
+                                (e == SKY_EVENT_SUNRISE) || (e == SKY_EVENT_CIVIL_DAWN) ||
+                                (e == SKY_EVENT_NAUTICAL_DAWN) || (e == SKY_EVENT_MOONRISE));
+      if ((ref == SKY_EVENT_NONE) != (events.time[e] == SKY_EVENT_NONE)) {
+        mismatch[e]++;
+        continue;
+      }
+      if (ref == SKY_EVENT_NONE)
+        continue;
+      long err = labs((long)(events.time[e] - ref));
+      if (err > max_err[e]) max_err[e] = err;
+      sum_err[e] += err;
+      count[e]++;
+    }
+  }
+  printf("lat %6.1f  %.2f evaluations per solved event (%.1f per day)\n",
+         latitude, (double)evaluations / solved, (double)evaluations / DAYS);
+  for (int e = 0; e < SKY_EVENT_COUNT; e++)
+    printf("  %-14s days %3d  max err %4ld s  mean %5.1f s  missed/extra %d\n", s_names[e],
+           count[e], max_err[e], count[e] ? (double)sum_err[e] / count[e] : 0.0, mismatch[e]);
+}
+
+int main(void) {
+  const float latitudes[] = { 64.8f, 40.0f, 0.0f, -33.9f };
+  const float longitudes[] = { -147.0f, -74.0f, 0.0f, 151.2f };
+  for (unsigned i = 0; i < sizeof(latitudes)/sizeof(latitudes[0]); i++)
+    prv_run(latitudes[i], longitudes[i]);
+  return 0;
+}
@@ -0,0 +1,168 @@
+//
+// Lunar series: accuracy against cost for each LUNAR_TERMS, on the host.
+//
+// The term count is a build time choice, so build and run once per count
+// from the repository root:
+//
+//   for n in 1 2 3 4 6 8 12 16 20; do cc -O2 -DLUNAR_TERMS=$n -I tools/host -I src/c -o bench_lunar tools/bench/bench_lunar.c src/c/ephemeris.c src/c/ephemeris_fixed.c tools/host/pebble_host.c -lm && ./bench_lunar; done
+//
+// Add -DEPHEMERIS_FLOAT_KERNEL to measure the float kernel instead.
+//
+// moonPosition() is compared over a year at ten minute steps, at a few
+// latitudes, against all rows of lunar_series.h in double precision with
+// the exact parallax.  Rise and set are compared where they matter: at
+// each reference moonrise/moonset the altitude difference is divided by
+// the reference altitude rate, giving the timing error in minutes.  The
+// "suncalc" line is the one term geocentric model the watch used before,
+// with its 0.125 degree rise altitude.  Cost is the host time and the sin/cos/atan2 lookups
+// per moonPosition() call; compare lookups, not nanoseconds, with the watch.
+//
+#include <pebble.h>
+#include <stdlib.h>
+#include <math.h>
+#include "ephemeris.h"
+#include "lunar_series.h"
+
+#define YEAR_START 1704067200  // 2024-01-01 00:00:00 UTC
+#define YEAR_STEP_SECS 600
+#define YEAR_SAMPLES (366 * SECS_IN_DAY / YEAR_STEP_SECS)
+#define PASSES 15
+#define RISE_ALT -0.825        // MOON_RISE_ALT in sky_events.c
+#define SUNCALC_RISE_ALT 0.125 // what it was with the one term model
+
+typedef struct RefTerm {
+  int D, M, Mp, F;
+  double micro, metres;
+} RefTerm;
+#define REF_TERM(D, M, Mp, F, micro, metres) { D, M, Mp, F, micro, metres },
+static const RefTerm s_longitude[] = { LUNAR_LONGITUDE_SERIES(REF_TERM) };
+static const RefTerm s_latitude[] = { LUNAR_LATITUDE_SERIES(REF_TERM) };
+
+static const double s_latitudes[] = { 64.8, 45.0, 0.0, -33.9 };
+static const double s_longitudes[] = { -147.0, 7.0, 0.0, 151.2 };
+#define LOCATIONS 4
+
+static volatile float s_sink;
+
+static double prv_now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static double prv_argument(const RefTerm *term, double d) {
+  double rad = M_PI / 180;
+  return rad * (term->D * (LUNAR_D_BASE + LUNAR_D_RATE * d) + term->M * (LUNAR_M_BASE + LUNAR_M_RATE * d) +
+                term->Mp * (LUNAR_MP_BASE + LUNAR_MP_RATE * d) + term->F * (LUNAR_F_BASE + LUNAR_F_RATE * d));
+}
+
+// Moon altitude in degrees: every row and the exact parallax, or with
+// suncalc set, the old one term geocentric model
+static double prv_ref_alt(bool suncalc, double latitude, double longitude, time_t t) {
+  double rad = M_PI / 180, e = rad * TILT_OF_EARTH;
+  double d = (double)(t - J2000) / SECS_IN_DAY - 0.5;
+  double l, b, parallax = 0;
+  if (suncalc) {
+    l = rad * (218.316 + 13.176396 * d) + rad * 6.289 * sin(rad * (134.963 + 13.064993 * d));
+    b = rad * 5.128 * sin(rad * (93.272 + 13.229350 * d));
+  }
+  else {
+    double distance = 385000560.0;  // metres
+    l = rad * (LUNAR_L_BASE + LUNAR_L_RATE * d);
+    b = 0;
+    for (int i = 0; i < LUNAR_SERIES_ROWS; i++) {
+      double arg = prv_argument(&s_longitude[i], d);
+      l += rad * LUNAR_DEGREES_OF(s_longitude[i].micro) * sin(arg);
+      distance += s_longitude[i].metres * cos(arg);
+      b += rad * LUNAR_DEGREES_OF(s_latitude[i].micro) * sin(prv_argument(&s_latitude[i], d));
+    }
+    parallax = asin(6378140.0 / distance);
+  }
+  double ra = atan2(sin(l) * cos(e) - tan(b) * sin(e), cos(l));
+  double dec = asin(sin(b) * cos(e) + cos(b) * sin(e) * sin(l));
+  double phi = rad * latitude;
+  double H = rad * (280.16 + 360.9856235 * d) + rad * longitude - ra;
+  double alt = asin(sin(phi) * sin(dec) + cos(phi) * cos(dec) * cos(H));
+  return (alt - parallax * cos(alt)) / rad;
+}
+
+static double prv_kernel_alt(const Observer *obs, time_t t) {
+  float azi, alt;
+  moonPosition(obs, t, NO_AZI, &azi, &alt);
+  return alt;
+}
+
+typedef struct Error {
+  double max;
+  double sum;
+  int count;
+} Error;
+
+static void prv_track(Error *err, double diff) {
+  if (fabs(diff) > err->max) err->max = fabs(diff);
+  err->sum += fabs(diff);
+  err->count++;
+}
+
+// reference crossing of RISE_ALT between t and t + YEAR_STEP_SECS, to a second
+static time_t prv_crossing(double latitude, double longitude, time_t t) {
+  time_t lo = t, hi = t + YEAR_STEP_SECS;
+  bool rising = prv_ref_alt(false, latitude, longitude, lo) < RISE_ALT;
+  while (hi - lo > 1) {
+    time_t mid = lo + (hi - lo) / 2;
+    if ((prv_ref_alt(false, latitude, longitude, mid) < RISE_ALT) == rising) lo = mid;
+    else hi = mid;
+  }
+  return lo;
+}
+
+int main(void) {
+  Error alt = {0}, rise = {0}, suncalc_alt = {0}, suncalc_rise = {0};
+  for (int loc = 0; loc < LOCATIONS; loc++) {
+    double latitude = s_latitudes[loc], longitude = s_longitudes[loc];
+    Observer obs;
+    observer_init(&obs, latitude, longitude);
+    double prev = prv_ref_alt(false, latitude, longitude, YEAR_START);
+    for (int i = 0; i < YEAR_SAMPLES; i++) {
+      time_t t = YEAR_START + (time_t)i * YEAR_STEP_SECS;
+      double ref = (i == 0) ? prev : prv_ref_alt(false, latitude, longitude, t);
+      prv_track(&alt, prv_kernel_alt(&obs, t) - ref);
+      prv_track(&suncalc_alt, prv_ref_alt(true, latitude, longitude, t) - ref);
+
+      double next = prv_ref_alt(false, latitude, longitude, t + YEAR_STEP_SECS);
+      if ((ref < RISE_ALT) != (next < RISE_ALT)) {
+        time_t crossing = prv_crossing(latitude, longitude, t);
+        double rate = (prv_ref_alt(false, latitude, longitude, crossing + 30) -
+                       prv_ref_alt(false, latitude, longitude, crossing - 30)) / 60;  // degrees per second
+        double ref_at = prv_ref_alt(false, latitude, longitude, crossing);
+        prv_track(&rise, (prv_kernel_alt(&obs, crossing) - ref_at) / rate / 60);
+        prv_track(&suncalc_rise, (prv_ref_alt(true, latitude, longitude, crossing) - SUNCALC_RISE_ALT -
+                                  (ref_at - RISE_ALT)) / rate / 60);
+      }
+      prev = next;
+    }
+  }
+
+  // cost of one moonPosition() call, best pass of a year's worth
+  Observer obs;
+  observer_init(&obs, s_latitudes[1], s_longitudes[1]);
+  double ns_per_call = 1e30;
+  for (int pass = 0; pass < PASSES; pass++) {
+    double start = prv_now_ns();
+    for (int i = 0; i < YEAR_SAMPLES; i++)
+      s_sink = prv_kernel_alt(&obs, YEAR_START + (time_t)i * YEAR_STEP_SECS);
+    double pass_ns = (prv_now_ns() - start) / YEAR_SAMPLES;
+    if (pass_ns < ns_per_call) ns_per_call = pass_ns;
+  }
+  uint32_t lookups = pebble_host_trig_lookups;
+  s_sink = prv_kernel_alt(&obs, YEAR_START);
+  lookups = pebble_host_trig_lookups - lookups;
+
+  printf("suncalc     alt err max %6.3f mean %6.3f deg   rise/set err max %5.1f mean %5.2f min\n",
+         suncalc_alt.max, suncalc_alt.sum / suncalc_alt.count,
+         suncalc_rise.max, suncalc_rise.sum / suncalc_rise.count);
+  printf("terms %2d    alt err max %6.3f mean %6.3f deg   rise/set err max %5.1f mean %5.2f min"
+         "   %6.1f ns/call %3u lookups\n", LUNAR_TERMS,
+         alt.max, alt.sum / alt.count, rise.max, rise.sum / rise.count, ns_per_call, (unsigned)lookups);
+  return 0;
+}
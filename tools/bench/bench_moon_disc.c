@@ -0,0 +1,105 @@
+//
+// Procedural moon sprite: rebuild cost, draw cost and phase accuracy, on the host.
+//
+// Build and run from the repository root:
+//
+//   cc -O2 -I tools/host -I src/c -o bench_moon_disc tools/bench/bench_moon_disc.c src/c/moon_disc.c src/c/ephemeris.c src/c/ephemeris_fixed.c tools/host/pebble_host.c -lm
+//   ./bench_moon_disc
+//
+// For a year at a few latitudes the disc is brought up to date every ten
+// minutes, as the canvas timer would at most, and drawn once per update.
+// The report gives how often the span table is rebuilt and actually
+// changes (against the nine bitmaps, which changed about 9 times a month),
+// the cost of a rebuild in lookups and host time, the draw calls and
+// pixels per frame (a 13x13 bitmap blit composites 169 pixels), and how
+// far the lit share of the drawn pixels is from the illuminated fraction.
+// Discs through one lunation are printed at the end.
+//
+#include <pebble.h>
+#include <stdlib.h>
+#include <math.h>
+#include "ephemeris.h"
+#include "moon_disc.h"
+
+#define YEAR_START 1704067200  // 2024-01-01 00:00:00 UTC
+#define DAYS 366
+#define STEP_SECS 600
+#define DISC_PIXELS 137        // pixels inside the disc outline
+
+static const float s_latitudes[] = { 64.8, 45.0, 0.0, -33.9 };
+static const float s_longitudes[] = { -147.0, 7.0, 0.0, 151.2 };
+#define LOCATIONS 4
+
+static double prv_now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int prv_lit_pixels(const MoonDisc *disc) {
+  int lit = 0;
+  for (int row = 0; row < MOON_DISC_SIZE; row++)
+    for (int i = 0; i < 2; i++)
+      if (disc->spans[row][i].start >= 0)
+        lit += disc->spans[row][i].end - disc->spans[row][i].start + 1;
+  return lit;
+}
+
+static void prv_print(const MoonDisc *disc, const char *label) {
+  memset(pebble_host_frame, 0, sizeof(pebble_host_frame));
+  moon_disc_draw(disc, NULL, GPoint(0, 0));
+  printf("%s  lit %.2f  limb %3.0f deg\n", label, disc->lit_q15 / 32768.0,
+         disc->limb_angle * 360.0 / TRIG_MAX_ANGLE);
+  for (int y = 0; y < MOON_DISC_SIZE; y++) {
+    printf("  ");
+    for (int x = 0; x < MOON_DISC_SIZE; x++)
+      putchar(pebble_host_frame[y][x] ? '#' : '.');
+    putchar('\n');
+  }
+}
+
+int main(void) {
+  for (int loc = 0; loc < LOCATIONS; loc++) {
+    Observer obs;
+    observer_init(&obs, s_latitudes[loc], s_longitudes[loc]);
+    MoonDisc disc = { 0 };
+    uint32_t changes = 0, frames = 0, draw_calls = 0, pixels = 0, lookups = 0;
+    double rebuild_ns = 0, max_err = 0, sum_err = 0;
+    for (time_t t = YEAR_START; t < YEAR_START + DAYS * SECS_IN_DAY; t += STEP_SECS) {
+      uint32_t rebuilds = disc.rebuilds, before = pebble_host_trig_lookups;
+      double start = prv_now_ns();
+      if (moon_disc_update(&disc, &obs, t)) changes++;
+      if (disc.rebuilds != rebuilds) {
+        rebuild_ns += prv_now_ns() - start;
+        lookups += pebble_host_trig_lookups - before;
+        double err = fabs((double)prv_lit_pixels(&disc) / DISC_PIXELS - disc.lit_q15 / 32768.0);
+        if (err > max_err) max_err = err;
+        sum_err += err;
+      }
+      uint32_t calls = pebble_host_draw_calls, drawn = pebble_host_pixels_drawn;
+      moon_disc_draw(&disc, NULL, GPoint(0, 0));
+      draw_calls += pebble_host_draw_calls - calls;
+      pixels += pebble_host_pixels_drawn - drawn;
+      frames++;
+    }
+    printf("lat %6.1f  rebuilds %5.1f/day  changes %5.1f/day  %4.1f lookups %6.0f ns/rebuild  "
+           "%4.1f draw calls %5.1f pixels/frame  lit share err max %.3f mean %.3f\n",
+           s_latitudes[loc], (double)disc.rebuilds / DAYS, (double)changes / DAYS,
+           (double)lookups / disc.rebuilds, rebuild_ns / disc.rebuilds,
+           (double)draw_calls / frames, (double)pixels / frames,
+           max_err, sum_err / disc.rebuilds);
+  }
+
+  // one lunation from the new moon of 2024-01-11, 45N at 21:00 UTC
+  printf("\n");
+  Observer obs;
+  observer_init(&obs, 45.0, 7.0);
+  for (int day = 1; day < 30; day += 4) {
+    MoonDisc disc = { 0 };
+    char label[32];
+    moon_disc_update(&disc, &obs, 1704999600 + day * SECS_IN_DAY);
+    snprintf(label, sizeof(label), "day %2d", day);
+    prv_print(&disc, label);
+  }
+  return 0;
+}
@@ -0,0 +1,143 @@
+//
+// Screen projection: the float mapping against the integer tables, on the host.
+//
+// Build and run from the repository root:
+//
+//   cc -O2 -I tools/host -I src/c -o bench_projection tools/bench/bench_projection.c src/c/sky_layout.c src/c/sky_path.c src/c/ephemeris.c src/c/ephemeris_fixed.c tools/host/pebble_host.c -lm
+//   ./bench_projection
+//
+// Every minute of a year of solar and lunar elevations at a few latitudes
+// is put on the 144 x 67 canvas by the float hour_to_xpixel() and
+// angle_to_ypixel() the face used to call, which worked the elevation scale
+// out from the latitude on every point, and by sky_layout_point().  Then
+// again on the dial of a 180 x 72 round canvas, against the same geometry
+// in doubles.  The report gives the host time per point, the share of
+// points that land elsewhere and the most they are off along either axis,
+// and the cost of building the tables for a new location.
+//
+#include <pebble.h>
+#include <stdlib.h>
+#include <math.h>
+#include "ephemeris.h"
+#include "sky_path.h"
+#include "sky_layout.h"
+
+#define YEAR_START 1704067200  // 2024-01-01 00:00:00 UTC
+#define DAYS 366
+#define MINUTES (24*60)
+#define POINTS (DAYS * (MINUTES + 1))
+
+static int16_t s_elev_x100[2][POINTS];
+static volatile int s_sink;
+
+static double prv_now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// the float mapping as it was, scale and all
+static void prv_elev_scale(float latitude, int *top, int *range) {
+  *range = (90 - fabs_pebble(latitude) + TILT_OF_EARTH) * 1.35;
+  if (*range>110) *range = 110;
+  *top = (90 - fabs_pebble(latitude) + TILT_OF_EARTH) * 1.05;
+  if (*top>90) *top = 90;
+}
+
+static int prv_float_x(float width, float hour) {
+  return (int)(hour/24 * width);
+}
+
+static int prv_float_y(float height, float latitude, float angle) {
+  int top, range;
+  prv_elev_scale(latitude, &top, &range);
+  return (int)(((top-angle)*height)/range);
+}
+
+static GPoint prv_float_dial(const SkyLayout *layout, int minute, float angle) {
+  int top, range;
+  prv_elev_scale(layout->latitude, &top, &range);
+  double r = (angle - (top - range)) * layout->radius / range;
+  double a = 2*PI * minute / MINUTES + PI;
+  return GPoint((int)floor(layout->center.x + r*sin(a)), (int)floor(layout->center.y - r*cos(a)));
+}
+
+// pixels off along whichever axis is off more
+static int prv_axis_err(GPoint p, GPoint q) {
+  int dx = abs(p.x - q.x), dy = abs(p.y - q.y);
+  return (dx > dy) ? dx : dy;
+}
+
+static void prv_run(float latitude) {
+  Observer obs;
+  observer_init(&obs, latitude, -147);
+  for (int day = 0; day < DAYS; day++) {
+    time_t start = YEAR_START + (time_t)day * SECS_IN_DAY;
+    sky_path_fill(SKY_BODY_SUN, &obs, start, MINUTES + 1, 60, &s_elev_x100[0][day * (MINUTES + 1)]);
+    sky_path_fill(SKY_BODY_MOON, &obs, start, MINUTES + 1, 60, &s_elev_x100[1][day * (MINUTES + 1)]);
+  }
+
+  static SkyLayout graph, dial;
+  graph.latitude = dial.latitude = latitude;
+  uint32_t before = pebble_host_trig_lookups;
+  double start = prv_now_ns();
+  sky_layout_init(&graph, 144, 67, false);
+  double graph_build_ns = prv_now_ns() - start;
+  start = prv_now_ns();
+  sky_layout_init(&dial, 180, 72, true);
+  double dial_build_ns = prv_now_ns() - start;
+  uint32_t dial_lookups = pebble_host_trig_lookups - before;
+
+  double float_ns = 0, graph_ns = 0, dial_ns = 0;
+  long graph_off = 0, dial_off = 0;
+  int graph_max = 0, dial_max = 0;
+  for (int body = 0; body < 2; body++) {
+    const int16_t *elev = s_elev_x100[body];
+    int sum = 0;
+    start = prv_now_ns();
+    for (int i = 0; i < POINTS; i++) {
+      int m = i % (MINUTES + 1);
+      sum += prv_float_x(graph.graph_width, m / 60.0f) + prv_float_y(graph.graph_height, latitude, elev[i] / 100.0f);
+    }
+    float_ns += prv_now_ns() - start;
+    start = prv_now_ns();
+    for (int i = 0; i < POINTS; i++) {
+      GPoint p = sky_layout_point(&graph, i % (MINUTES + 1), elev[i]);
+      sum += p.x + p.y;
+    }
+    graph_ns += prv_now_ns() - start;
+    start = prv_now_ns();
+    for (int i = 0; i < POINTS; i++) {
+      GPoint p = sky_layout_point(&dial, i % (MINUTES + 1), elev[i]);
+      sum += p.x + p.y;
+    }
+    dial_ns += prv_now_ns() - start;
+    s_sink = sum;
+
+    for (int i = 0; i < POINTS; i++) {
+      int m = i % (MINUTES + 1);
+      GPoint p = sky_layout_point(&graph, m, elev[i]);
+      GPoint q = GPoint(prv_float_x(graph.graph_width, m / 60.0f),
+                        prv_float_y(graph.graph_height, latitude, elev[i] / 100.0f));
+      int err = prv_axis_err(p, q);
+      if (err) graph_off++;
+      if (err > graph_max) graph_max = err;
+      p = sky_layout_point(&dial, m, elev[i]);
+      err = prv_axis_err(p, prv_float_dial(&dial, m, elev[i] / 100.0f));
+      if (err) dial_off++;
+      if (err > dial_max) dial_max = err;
+    }
+  }
+  printf("lat %6.1f  float %4.1f ns/point  graph %4.1f ns/point, %.2f%% off by up to %d px an axis, "
+         "built in %4.0f ns  dial %4.1f ns/point, %.2f%% off by up to %d px an axis, built in %4.0f ns with %u lookups\n",
+         latitude, float_ns / (2*POINTS), graph_ns / (2*POINTS), 50.0 * graph_off / POINTS, graph_max,
+         graph_build_ns, dial_ns / (2*POINTS), 50.0 * dial_off / POINTS, dial_max, dial_build_ns,
+         (unsigned)dial_lookups);
+}
+
+int main(void) {
+  const float latitudes[] = { 78.0f, 64.8f, 45.0f, 0.0f, -33.9f };
+  for (unsigned i = 0; i < sizeof(latitudes)/sizeof(latitudes[0]); i++)
+    prv_run(latitudes[i]);
+  return 0;
+}
@@ -0,0 +1,147 @@
+//
+// Canvas redraws per day: per-minute refresh against the pixel-crossing
+// scheduler, on the host.
+//
+// Build and run from the repository root:
+//
+//   cc -O2 -I tools/host -I src/c -o bench_redraws tools/bench/bench_redraws.c src/c/sky_layout.c src/c/sky_path.c src/c/ephemeris.c src/c/ephemeris_fixed.c tools/host/pebble_host.c -lm
+//   ./bench_redraws
+//
+// For every day of a year and a few latitudes, the sprites are placed on a
+// 144x168 screen minute by minute, the way the watchface places them, and
+// again on the dial of a 180x180 round screen.  The
+// per-minute refresh wakes the canvas 1440 times a day; the scheduler wakes
+// it when sky_layout_minutes_to_move() says a sprite moves.  "changes" is
+// how many minutes really show something new, and "missed" counts changes
+// the scheduler slept through, which must be zero.  "sun swaps" counts
+// changes of the sun image, against the swaps the old threshold without
+// hysteresis would make.
+//
+#include <pebble.h>
+#include <stdlib.h>
+#include "ephemeris.h"
+#include "sky_path.h"
+#include "sky_layout.h"
+
+#define YEAR_START 1704067200  // 2024-01-01 00:00:00 UTC
+#define DAYS 366
+#define MINUTES_IN_DAY (24*60)
+#define MAX_SLEEP_MINUTES 60  // as CANVAS_MAX_SLEEP_MINUTES in main.c
+
+static int16_t s_solar[25];
+static int16_t s_lunar[25];
+static SkyTables s_tables = { s_solar, s_lunar, 0, 0, 0 };
+
+// The lunar shift as redo_sky_paths() works it out at solar hour:minute
+static void prv_lunar_shift(time_t t, int hour, int minute, int *offset_hour, int *day_shift,
+                            int *fine_shift_min) {
+  float solar_display_hour = (float)hour + (float)minute/60;
+  float lunar_display_hour = fmod_pebble(solar_display_hour -
+                             24*moonPhase(t)*(SECS_IN_DAY)/((float)MOONPERIOD_SEC),24);
+  int lunar_side = (lunar_display_hour > solar_display_hour) ? -1 : +1;
+  float fine = -24*moonPhase(t)*(SECS_IN_DAY)/((float)MOONPERIOD_SEC);
+  if (fine < -12)
+    fine += 24;
+  *day_shift = 0;
+  if ((fine < 0) && (lunar_side == -1))
+    *day_shift = -1;
+  if ((fine > 0) && (lunar_side == +1))
+    *day_shift = +1;
+  *offset_hour = round_to_int(fine);
+  *fine_shift_min = round_to_int((fine - (float)*offset_hour)*60);
+}
+
+// Tables for the day starting at midnight, as the app recomputes them at a minute of it
+static void prv_redo(const Observer *obs, time_t midnight, int minute) {
+  time_t t = midnight + (time_t)minute * 60;
+  prv_lunar_shift(t, minute / 60, minute % 60, &s_tables.lunar_offset_hour, &s_tables.lunar_day_shift,
+                  &s_tables.lunar_fine_shift_min);
+  sky_path_fill(SKY_BODY_SUN, obs, midnight, 25, SECS_IN_HOUR, s_solar);
+  sky_path_fill(SKY_BODY_MOON, obs,
+                midnight + (time_t)(-SECS_IN_HOUR*s_tables.lunar_offset_hour +
+                                    SECS_IN_DAY*s_tables.lunar_day_shift),
+                25, SECS_IN_HOUR, s_lunar);
+}
+
+// Precise lunar elevation, what update_positions() falls back to
+static float prv_lunar_elev(const Observer *obs, time_t t) {
+  float azi, alt;
+  moonPosition(obs, t, NO_AZI, &azi, &alt);
+  return alt;
+}
+
+static bool prv_same(const SkySprites *a, const SkySprites *b) {
+  return !memcmp(&a->sun, &b->sun, sizeof(GRect)) && !memcmp(&a->moon, &b->moon, sizeof(GRect)) &&
+         (a->sun_risen == b->sun_risen);
+}
+
+static void prv_run(const SkyLayout *layout, float latitude, float longitude) {
+  Observer obs;
+  observer_init(&obs, latitude, longitude);
+  // local solar midnight stands in for the time zone
+  time_t zone = (time_t)(-longitude/15) * SECS_IN_HOUR;
+  long changes = 0, wakeups = 0, missed = 0, swaps = 0, plain_swaps = 0;
+  bool risen = false, plain_risen = false;
+  int longest_sleep = 0;
+
+  for (int day = 0; day < DAYS; day++) {
+    time_t midnight = YEAR_START + (time_t)day * SECS_IN_DAY + zone;
+    SkySprites shown, now;
+    int next_wakeup = 0, last_redo = 0;
+    for (int minute = 0; minute < MINUTES_IN_DAY; minute++) {
+      int hour = minute / 60;
+      // the canvas timer redoes stale tables when it wakes, never in between
+      if ((minute == 0) || ((minute == next_wakeup) && (minute - last_redo >= 60))) {
+        prv_redo(&obs, midnight, minute);
+        last_redo = minute;
+      }
+      float lunar_elev = prv_lunar_elev(&obs, midnight + (time_t)minute * 60);
+      sky_layout_sprites(layout, &s_tables, hour, minute % 60, lunar_elev, risen, &now);
+      if (now.sun_risen != risen) swaps++;
+      risen = now.sun_risen;
+      // the old rule: risen whenever the elevation rounds above zero
+      bool plain = round_to_int(sky_path_elev_at(s_solar, hour, minute % 60)/100.0f) > 0;
+      if (plain != plain_risen) plain_swaps++;
+      plain_risen = plain;
+      bool changed = (minute == 0) || !prv_same(&shown, &now);
+      if (changed)
+        changes++;
+      if (minute == next_wakeup) {
+        wakeups++;
+        shown = now;
+        int sleep = sky_layout_minutes_to_move(layout, &s_tables, hour, minute % 60, lunar_elev,
+                                               now.sun_risen, MAX_SLEEP_MINUTES);
+        if (sleep > longest_sleep) longest_sleep = sleep;
+        next_wakeup = minute + sleep;
+      }
+      else if (changed) {
+        missed++;
+        shown = now;
+      }
+    }
+  }
+  printf("lat %6.1f  per-minute %5d/day  scheduler %6.1f/day  changes %6.1f/day  "
+         "longest sleep %2d min  missed %ld  sun swaps %ld (without hysteresis %ld)\n",
+         latitude, MINUTES_IN_DAY, (double)wakeups / DAYS, (double)changes / DAYS,
+         longest_sleep, missed, swaps, plain_swaps);
+}
+
+static void prv_run_all(SkyLayout *layout, const char *shape) {
+  const float latitudes[] = { 66.2f, 64.8f, 40.0f, 0.0f, -33.9f };
+  const float longitudes[] = { -18.0f, -147.0f, -74.0f, 0.0f, 151.2f };
+  printf("canvas wakeups per day, %dx%d %s\n", layout->graph_width, layout->graph_height, shape);
+  for (unsigned i = 0; i < sizeof(latitudes)/sizeof(latitudes[0]); i++) {
+    sky_layout_set_latitude(layout, latitudes[i]);
+    prv_run(layout, latitudes[i], longitudes[i]);
+  }
+}
+
+int main(void) {
+  static SkyLayout layout;
+  sky_layout_init(&layout, 144, 168*0.4, false);
+  prv_run_all(&layout, "graph");
+  // chalk's canvas, drawn as a dial
+  sky_layout_init(&layout, 180, 180*0.4, true);
+  prv_run_all(&layout, "dial");
+  return 0;
+}
@@ -0,0 +1,108 @@
+//
+// Path samples against the hourly table, on the host.
+//
+// Build and run from the repository root:
+//
+//   cc -O2 -I tools/host -I src/c -o bench_samples tools/bench/bench_samples.c src/c/sky_samples.c src/c/sky_layout.c src/c/sky_path.c src/c/ephemeris.c src/c/ephemeris_fixed.c tools/host/pebble_host.c -lm
+//   ./bench_samples
+//
+// For every day of a year and a few latitudes each path is drawn two ways:
+// straight through the 25 row hourly table, and through the 97 quarter
+// hour samples.  Every minute the path is above the horizon, the row the
+// line is drawn on (144 x 67 canvas) is compared with the row of the
+// position computed for that minute.  The report gives points and bytes
+// per path, lookups per build, and the worst and mean row error and share
+// of minutes off by a pixel or more.  On the watch the hourly table
+// usually comes from the store, the samples are always the watch's own.
+//
+#include <pebble.h>
+#include <stdlib.h>
+#include "ephemeris.h"
+#include "sky_path.h"
+#include "sky_samples.h"
+#include "sky_layout.h"
+
+#define YEAR_START 1704067200  // 2024-01-01 00:00:00 UTC
+#define DAYS 366
+#define MINUTES (24*60)
+
+typedef struct Errors {
+  long points, lookups, minutes, off, sum;
+  int max;
+} Errors;
+
+static int32_t s_reference[MINUTES + 1];
+
+// elevation x100 the line through count evenly spaced points gives at minute m
+static int32_t prv_line_at(const int16_t *elev_x100, int count, int m) {
+  int step = MINUTES / (count - 1);
+  int i = m / step;
+  if (i + 1 >= count) i = count - 2;
+  return elev_x100[i] + (elev_x100[i+1] - elev_x100[i]) * (m - i * step) / step;
+}
+
+static void prv_score(const SkyLayout *layout, const int16_t *elev_x100, int count, Errors *errors) {
+  errors->points += count;
+  for (int m = 0; m <= MINUTES; m++) {
+    if (s_reference[m] <= 0)
+      continue;
+    int err = abs(sky_layout_depth(layout, prv_line_at(elev_x100, count, m)) -
+                  sky_layout_depth(layout, s_reference[m]));
+    errors->minutes++;
+    errors->sum += err;
+    if (err > 0) errors->off++;
+    if (err > errors->max) errors->max = err;
+  }
+}
+
+static void prv_report(const char *name, const Errors *errors) {
+  printf("    %-8s %3d points %4d bytes %6.1f lookups  row err max %d mean %.3f, %4.1f%% of minutes off\n",
+         name, (int)(errors->points / DAYS), (int)(errors->points / DAYS * sizeof(int16_t)),
+         (double)errors->lookups / DAYS, errors->max,
+         (double)errors->sum / errors->minutes, 100.0 * errors->off / errors->minutes);
+}
+
+static void prv_run(SkyBody body, float latitude) {
+  Observer obs;
+  observer_init(&obs, latitude, -147);
+  static SkyLayout layout;
+  layout.latitude = latitude;
+  sky_layout_init(&layout, 144, 67, false);
+  SkySamples samples = { 0 };
+  Errors hourly = { 0 }, quarters = { 0 };
+
+  for (int day = 0; day < DAYS; day++) {
+    time_t start = YEAR_START + (time_t)day * SECS_IN_DAY;
+    for (int m = 0; m <= MINUTES; m++) {
+      int32_t azi, alt;
+      if (body == SKY_BODY_SUN)
+        sunPositionFixed(&obs, start + m * 60, NO_AZI, &azi, &alt);
+      else
+        moonPositionFixed(&obs, start + m * 60, NO_AZI, &azi, &alt);
+      s_reference[m] = angle_to_x100(alt);
+    }
+
+    int16_t table[25];
+    uint32_t before = pebble_host_trig_lookups;
+    sky_path_fill(body, &obs, start, 25, SECS_IN_HOUR, table);
+    hourly.lookups += pebble_host_trig_lookups - before;
+    prv_score(&layout, table, 25, &hourly);
+
+    before = pebble_host_trig_lookups;
+    sky_samples_update(&samples, body, &obs, start);
+    quarters.lookups += pebble_host_trig_lookups - before;
+    prv_score(&layout, samples.elev_x100, SKY_SAMPLES_COUNT, &quarters);
+  }
+  printf("%-5s lat %6.1f\n", body == SKY_BODY_SUN ? "sun" : "moon", latitude);
+  prv_report("hourly", &hourly);
+  prv_report("samples", &quarters);
+}
+
+int main(void) {
+  const float latitudes[] = { 64.8, 45, 0, -33.9, 78 };
+  for (unsigned i = 0; i < sizeof(latitudes)/sizeof(latitudes[0]); i++) {
+    prv_run(SKY_BODY_SUN, latitudes[i]);
+    prv_run(SKY_BODY_MOON, latitudes[i]);
+  }
+  return 0;
+}
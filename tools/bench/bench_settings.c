@@ -0,0 +1,91 @@
+//
+// Settings flash writes: the raw struct written on every save against the
+// versioned write-if-changed record, on the host.
+//
+// Build and run from the repository root:
+//
+//   cc -O2 -I tools/host -I src/c -o bench_settings tools/bench/bench_settings.c src/c/settings_store.c tools/host/pebble_host.c -lm
+//   ./bench_settings
+//
+// A layout from before SETTINGS_VERSION 1 is stored first and must load
+// unchanged.  Then a month of use is replayed the way main.c saves: at
+// every exit, and after every settings message from the phone.  Each day
+// the face is launched LAUNCHES_PER_DAY times, the info line is tapped on
+// TAPS_PER_DAY of them, Clay resends the same settings once, and once a
+// week the location really changes.
+//
+#include <pebble.h>
+#include <stdlib.h>
+#include "settings_store.h"
+
+#define SETTINGS_KEY 1
+#define NUM_INFO_ITEMS 9
+#define DAYS 30
+#define LAUNCHES_PER_DAY 40
+#define TAPS_PER_DAY 3
+
+// the struct main.c wrote with persist_write_data before
+typedef struct OldSettings {
+  float Latitude;
+  float Longitude;
+  bool ShowInfo;
+  time_t dayshift_secs;
+  int info_display;
+  int curr_solar_elev_int;
+  int curr_solar_azi_int;
+  int curr_lunar_elev_int;
+  int curr_lunar_azi_int;
+} OldSettings;
+
+static bool prv_same(const ClaySettings *a, const ClaySettings *b) {
+  return (a->Latitude == b->Latitude) && (a->Longitude == b->Longitude) &&
+         (a->ShowInfo == b->ShowInfo) && (a->dayshift_secs == b->dayshift_secs) &&
+         (a->info_display == b->info_display);
+}
+
+int main(void) {
+  OldSettings old = { 51, -1, true, 0, 4, 12, 170, -20, 300 };
+  persist_write_data(SETTINGS_KEY, &old, sizeof(old));
+  pebble_host_persist_writes = 0;
+
+  SettingsStore store = { 0 };
+  ClaySettings settings = { 64.8f, -147, true, 0, 0 };
+  bool migrated = settings_store_load(&store, SETTINGS_KEY, &settings);
+  ClaySettings expect = { 51, -1, true, 0, 4 };
+  printf("migration: %s, %d bytes -> %d bytes, %s, %d write\n", migrated ? "loaded" : "FAILED",
+         (int)sizeof(OldSettings), (int)sizeof(SettingsRecord),
+         prv_same(&settings, &expect) ? "fields kept" : "FIELDS CHANGED", (int)pebble_host_persist_writes);
+
+  SettingsStore reload = { 0 };
+  ClaySettings again = { 0 };
+  settings_store_load(&reload, SETTINGS_KEY, &again);
+  printf("reload: %s, %d migrations\n", prv_same(&again, &settings) ? "same" : "DIFFERENT",
+         (int)reload.migrations);
+
+  long old_writes = 0;
+  uint32_t before = pebble_host_persist_writes;
+  for (int day = 0; day < DAYS; day++) {
+    for (int launch = 0; launch < LAUNCHES_PER_DAY; launch++) {
+      int info_offset = 0;
+      if (launch == 0) {
+        // Clay resends the stored settings, and weekly a new location
+        if (day % 7 == 6)
+          settings.Latitude += 1;
+        settings_store_save(&store, SETTINGS_KEY, &settings);
+        old_writes++;
+      }
+      if (launch < TAPS_PER_DAY)
+        info_offset++;
+      // exit
+      ClaySettings stored = settings;
+      stored.info_display = (settings.info_display + info_offset) % NUM_INFO_ITEMS;
+      settings_store_save(&store, SETTINGS_KEY, &stored);
+      settings.info_display = stored.info_display;
+      old_writes++;
+    }
+  }
+  printf("%d days, %d launches a day: raw struct %ld writes, record %d writes, %d avoided\n",
+         DAYS, LAUNCHES_PER_DAY, old_writes, (int)(pebble_host_persist_writes - before),
+         (int)store.writes_avoided);
+  return 0;
+}
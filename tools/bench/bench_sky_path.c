@@ -0,0 +1,102 @@
+//
+// Sky path tables: stepping engine against direct evaluation, on the host.
+//
+// Build and run from the repository root:
+//
+//   cc -O2 -I tools/host -I src/c -o bench_sky_path tools/bench/bench_sky_path.c src/c/sky_path.c src/c/ephemeris.c src/c/ephemeris_fixed.c tools/host/pebble_host.c -lm
+//   ./bench_sky_path
+//
+// For every day of a year and a few latitudes, the 25 point hourly tables
+// are built both ways.  The drift check reports the largest difference in
+// hundredths of a degree; the timing reports the cost per table.
+//
+#include <pebble.h>
+#include <stdlib.h>
+#include "ephemeris.h"
+#include "sky_path.h"
+
+#define YEAR_START 1704067200  // 2024-01-01 00:00:00 UTC
+#define DAYS 366
+#define POINTS 25
+
+static volatile int16_t s_sink;
+
+static double prv_now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// what redo_sky_paths used to do: the full pipeline at every point
+static void prv_direct_fill(SkyBody body, const Observer *obs, time_t start, int16_t *elev_x100) {
+  for (int i = 0; i < POINTS; i++) {
+    int32_t azi, alt;
+    if (body == SKY_BODY_SUN)
+      sunPositionFixed(obs, start + i * SECS_IN_HOUR, NO_AZI, &azi, &alt);
+    else
+      moonPositionFixed(obs, start + i * SECS_IN_HOUR, NO_AZI, &azi, &alt);
+    elev_x100[i] = (int16_t)angle_to_x100(alt);
+  }
+}
+
+static void prv_drift(SkyBody body, float latitude, float longitude) {
+  Observer obs;
+  observer_init(&obs, latitude, longitude);
+  int16_t direct[POINTS], stepped[POINTS];
+  int max_drift = 0;
+  long sum_drift = 0;
+  for (int day = 0; day < DAYS; day++) {
+    time_t start = YEAR_START + (time_t)day * SECS_IN_DAY;
+    prv_direct_fill(body, &obs, start, direct);
+    sky_path_fill(body, &obs, start, POINTS, SECS_IN_HOUR, stepped);
+    for (int i = 0; i < POINTS; i++) {
+      int drift = abs(direct[i] - stepped[i]);
+      if (drift > max_drift) max_drift = drift;
+      sum_drift += drift;
+    }
+  }
+  printf("%-5s lat %6.1f  max drift %5.2f deg  mean %5.3f deg\n",
+         body == SKY_BODY_SUN ? "sun" : "moon", latitude,
+         max_drift / 100.0, sum_drift / 100.0 / (DAYS * POINTS));
+}
+
+static void prv_timing(SkyBody body, bool stepped) {
+  Observer obs;
+  observer_init(&obs, 64.8, -147);
+  int16_t table[POINTS];
+  double best = 1e30;
+  uint32_t lookups = 0;
+  for (int pass = 0; pass < 15; pass++) {
+    uint32_t start_lookups = pebble_host_trig_lookups;
+    double start = prv_now_ns();
+    for (int day = 0; day < DAYS; day++) {
+      time_t t = YEAR_START + (time_t)day * SECS_IN_DAY;
+      if (stepped)
+        sky_path_fill(body, &obs, t, POINTS, SECS_IN_HOUR, table);
+      else
+        prv_direct_fill(body, &obs, t, table);
+      s_sink = table[POINTS/2];
+    }
+    double ns = (prv_now_ns() - start) / DAYS;
+    if (ns < best) best = ns;
+    lookups = (pebble_host_trig_lookups - start_lookups) / DAYS;
+  }
+  printf("%-5s %-8s %8.0f ns/table %4u lookups/table\n",
+         body == SKY_BODY_SUN ? "sun" : "moon", stepped ? "stepped" : "direct",
+         best, (unsigned)lookups);
+}
+
+int main(void) {
+  printf("drift of stepped tables against direct evaluation, %d days:\n", DAYS);
+  const float latitudes[] = { 64.8, 45, 0, -33.9, 78 };
+  for (unsigned i = 0; i < sizeof(latitudes)/sizeof(latitudes[0]); i++) {
+    prv_drift(SKY_BODY_SUN, latitudes[i], -147);
+    prv_drift(SKY_BODY_MOON, latitudes[i], -147);
+  }
+  printf("\ncost per %d point table:\n", POINTS);
+  prv_timing(SKY_BODY_SUN, false);
+  prv_timing(SKY_BODY_SUN, true);
+  prv_timing(SKY_BODY_MOON, false);
+  prv_timing(SKY_BODY_MOON, true);
+  return 0;
+}
@@ -0,0 +1,102 @@
+//
+// Startup cost of the sky path tables: computed at every launch, against
+// copied out of the persisted multi-day store, on the host.
+//
+// Build and run from the repository root:
+//
+//   cc -O2 -I tools/host -I src/c -o bench_startup tools/bench/bench_startup.c src/c/sky_store.c src/c/sky_path.c src/c/ephemeris.c src/c/ephemeris_fixed.c tools/host/pebble_host.c -lm
+//   ./bench_startup
+//
+// "compute" is what every launch used to do, both tables from scratch.
+// "cold" is a launch that finds no usable store and fills SKY_STORE_DAYS
+// days; "warm" loads, verifies and slices the store.  Trig lookups and
+// flash writes are counted, times are the best of several passes.
+//
+#include <pebble.h>
+#include <stdlib.h>
+#include "ephemeris.h"
+#include "sky_path.h"
+#include "sky_store.h"
+
+#define MIDNIGHT 1718928000  // 2024-06-21 00:00:00 UTC
+#define STORE_KEY 2
+#define PASSES 15
+#define LAUNCHES 2000
+
+static int16_t s_solar[25];
+static int16_t s_lunar[25];
+
+static double prv_now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// a lunar table shifted by five hours, as redo_sky_paths() might ask for
+#define LUNAR_START (MIDNIGHT - 5*SECS_IN_HOUR)
+
+static void prv_compute(const Observer *obs) {
+  sky_path_fill(SKY_BODY_SUN, obs, MIDNIGHT, 25, SECS_IN_HOUR, s_solar);
+  sky_path_fill(SKY_BODY_MOON, obs, LUNAR_START, 25, SECS_IN_HOUR, s_lunar);
+}
+
+static void prv_cold(const Observer *obs) {
+  static SkyStore store;
+  persist_delete(STORE_KEY);
+  if (!sky_store_load(&store, STORE_KEY)) {
+    sky_store_fill(&store, obs, MIDNIGHT);
+    sky_store_save(&store, STORE_KEY);
+  }
+  sky_store_table(&store, obs, SKY_BODY_SUN, MIDNIGHT, s_solar);
+  sky_store_table(&store, obs, SKY_BODY_MOON, LUNAR_START, s_lunar);
+}
+
+static void prv_warm(const Observer *obs) {
+  static SkyStore store;
+  if (!sky_store_load(&store, STORE_KEY)) {
+    fprintf(stderr, "warm launch missed the store\n");
+    exit(1);
+  }
+  sky_store_table(&store, obs, SKY_BODY_SUN, MIDNIGHT, s_solar);
+  sky_store_table(&store, obs, SKY_BODY_MOON, LUNAR_START, s_lunar);
+}
+
+static void prv_measure(const char *name, void (*launch)(const Observer *), const Observer *obs) {
+  double best = 1e30;
+  uint32_t lookups = 0, writes = 0;
+  for (int pass = 0; pass < PASSES; pass++) {
+    uint32_t lookups_before = pebble_host_trig_lookups;
+    uint32_t writes_before = pebble_host_persist_writes;
+    double t0 = prv_now_ns();
+    for (int i = 0; i < LAUNCHES; i++)
+      launch(obs);
+    double ns = (prv_now_ns() - t0) / LAUNCHES;
+    if (ns < best) best = ns;
+    lookups = (pebble_host_trig_lookups - lookups_before) / LAUNCHES;
+    writes = (pebble_host_persist_writes - writes_before) / LAUNCHES;
+  }
+  printf("%-8s %8.0f ns/launch  %4u trig lookups  %u flash writes\n", name, best, lookups, writes);
+}
+
+int main(void) {
+  Observer obs;
+  observer_init(&obs, 64.8f, -147.0f);
+  printf("store: %d days, %d bytes in %d keys\n", SKY_STORE_DAYS, (int)sizeof(SkyStore),
+         (int)SKY_STORE_KEYS);
+  prv_measure("compute", prv_compute, &obs);
+  prv_measure("cold", prv_cold, &obs);
+  prv_measure("warm", prv_warm, &obs);
+
+  // the warm tables must be the ones a direct fill gives, give or take the
+  // interpolation between a different set of nodes
+  int16_t direct[25];
+  int worst = 0;
+  sky_path_fill(SKY_BODY_MOON, &obs, LUNAR_START, 25, SECS_IN_HOUR, direct);
+  for (int i = 0; i < 25; i++)
+    if (abs(direct[i] - s_lunar[i]) > worst) worst = abs(direct[i] - s_lunar[i]);
+  sky_path_fill(SKY_BODY_SUN, &obs, MIDNIGHT, 25, SECS_IN_HOUR, direct);
+  for (int i = 0; i < 25; i++)
+    if (abs(direct[i] - s_solar[i]) > worst) worst = abs(direct[i] - s_solar[i]);
+  printf("stored against direct tables: worst %.2f deg\n", worst / 100.0);
+  return 0;
+}
@@ -0,0 +1,121 @@
+//
+// Sky store cache: fills saved by keeping several locations, on the host.
+//
+// Build and run from the repository root:
+//
+//   cc -O2 -I tools/host -I src/c -o bench_store_cache tools/bench/bench_store_cache.c src/c/sky_store.c src/c/sky_path.c src/c/ephemeris.c src/c/ephemeris_fixed.c tools/host/pebble_host.c -lm
+//   ./bench_store_cache
+//
+// A year of moving between fixed sites: a commute to work in the next town
+// on weekday office hours, then also weekends at a cabin, then also three
+// days away at the start of every month.  The tables are asked for every
+// hour, as redo_sky_paths() does.  Each itinerary is run against the
+// single store the watch used to keep (refilled whenever the location
+// changes) and against the cache.  The report gives the hits and misses;
+// every miss is a fill, and the lookups are what the fills cost.
+//
+#include <pebble.h>
+#include "ephemeris.h"
+#include "sky_path.h"
+#include "sky_store.h"
+
+#define YEAR_START 1704067200  // 2024-01-01 00:00:00 UTC, a Monday
+#define DAYS 366
+
+typedef struct Site {
+  const char *name;
+  float latitude;
+  float longitude;
+} Site;
+
+static const Site s_sites[] = {
+  { "home", 64.84f, -147.72f },
+  { "work", 64.56f, -149.09f },
+  { "cabin", 63.07f, -150.02f },
+  { "away", 47.61f, -122.33f },
+};
+
+typedef struct Itinerary {
+  const char *name;
+  int sites;   // how many of s_sites it visits
+} Itinerary;
+
+static const Itinerary s_itineraries[] = {
+  { "home and work", 2 },
+  { "home, work and cabin", 3 },
+  { "home, work, cabin and away", 4 },
+};
+
+static int prv_site_at(const Itinerary *itinerary, int day, int hour) {
+  if ((itinerary->sites > 3) && (day % 30 < 3))
+    return 3;
+  if (day % 7 >= 5)  // Saturday and Sunday
+    return (itinerary->sites > 2) ? 2 : 0;
+  return ((hour >= 8) && (hour < 17)) ? 1 : 0;
+}
+
+// the hour the lunar table is shifted back by, as in redo_sky_paths()
+static time_t prv_lunar_start(time_t midnight) {
+  int offset = round_to_int(-24*moonPhase(midnight)/29.530588f);
+  if (offset < -12) offset += 24;
+  return midnight - (time_t)offset*SECS_IN_HOUR;
+}
+
+typedef struct Tally {
+  uint32_t asks, hits, misses, lookups;
+} Tally;
+
+static void prv_report(const char *name, const Tally *tally) {
+  printf("    %-12s %5u asks  %5u hits  %4u misses (fills)  %8.0f lookups/day filling\n", name,
+         (unsigned)tally->asks, (unsigned)tally->hits, (unsigned)tally->misses,
+         (double)tally->lookups / DAYS);
+}
+
+static void prv_run(const Itinerary *itinerary) {
+  static SkyStore single;
+  static SkyStoreCache cache;
+  memset(&single, 0, sizeof(single));
+  memset(&cache, 0, sizeof(cache));
+  Tally old_tally = { 0 }, cache_tally = { 0 };
+  int16_t solar[25], lunar[25];
+  Observer obs = { 0 };
+
+  for (int day = 0; day < DAYS; day++) {
+    time_t midnight = YEAR_START + (time_t)day*SECS_IN_DAY;
+    time_t lunar_start = prv_lunar_start(midnight);
+    for (int hour = 0; hour < 24; hour++) {
+      const Site *site = &s_sites[prv_site_at(itinerary, day, hour)];
+      observer_set(&obs, site->latitude, site->longitude);
+      // the single store, refilled for any other location
+      uint32_t before = pebble_host_trig_lookups;
+      old_tally.asks++;
+      if (sky_store_table(&single, &obs, SKY_BODY_SUN, midnight, solar) &&
+          sky_store_table(&single, &obs, SKY_BODY_MOON, lunar_start, lunar)) {
+        old_tally.hits++;
+      }
+      else {
+        old_tally.misses++;
+        sky_store_fill(&single, &obs, midnight);
+      }
+      old_tally.lookups += pebble_host_trig_lookups - before;
+
+      before = pebble_host_trig_lookups;
+      bool filled;
+      cache_tally.asks++;
+      sky_store_cache_get(&cache, &obs, midnight, lunar_start, &filled);
+      cache_tally.lookups += pebble_host_trig_lookups - before;
+    }
+  }
+  cache_tally.hits = cache.hits;
+  cache_tally.misses = cache.misses;
+
+  printf("%s, %d slots of %d bytes:\n", itinerary->name, SKY_STORE_SLOTS, (int)sizeof(SkyStore));
+  prv_report("one store", &old_tally);
+  prv_report("cache", &cache_tally);
+}
+
+int main(void) {
+  for (unsigned i = 0; i < sizeof(s_itineraries)/sizeof(s_itineraries[0]); i++)
+    prv_run(&s_itineraries[i]);
+  return 0;
+}
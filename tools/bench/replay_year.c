@@ -0,0 +1,195 @@
+//
+// A year of the watchface, minute by minute, on the host.
+//
+// Build and run from the repository root:
+//
+//   cc -O2 -I tools/host -I src/c -o replay_year tools/bench/replay_year.c $(ls src/c/*.c | grep -v /main.c) tools/host/pebble_host.c tools/host/pebble_app_host.c -lm
+//   ./replay_year
+//   ./replay_year --no-worker
+//
+// main.c is compiled in here as it is, with the sky clock (sky_clock.h)
+// switched to a simulated one.  The face starts at local midnight on
+// 2024-01-01 in Fairbanks (Alaska time, with its daylight saving
+// changes) and every minute of the year is played through it: the app
+// timers fire when they fall due, the tick handler runs on the minute and
+// dirty layers are drawn.  For each day the report gives the
+// redo_sky_paths() calls, how many of them were avoided, the store fills
+// (computing the next few days), canvas draws, timers fired, trig lookups
+// and the host time spent in the face.  Add -DSKY_PROFILE to the build
+// for the profiler's totals as well.
+//
+// The background worker (worker_src/c/worker.c) is compiled in the same
+// way, turned on with the BackgroundWorker setting right after the face
+// starts, and launched by the face as on the watch.  Its messages are handed
+// over as soon as either side sends one, its hour tick runs on the hour,
+// and its time and lookups are kept apart from the face's.  With
+// --no-worker the face has none and fills every store itself, as it did
+// before there was one.
+//
+#define main ephemeris_main
+#include "main.c"
+#undef main
+#define main sky_worker_main
+#include "../../worker_src/c/worker.c"
+#undef main
+
+#include <stdlib.h>
+
+#define START 1704099600  // 2024-01-01 00:00 AKST
+#define DAYS 366
+#define TIME_ZONE "AKST9AKDT,M3.2.0,M11.1.0"
+
+static bool s_worker_on;  // false under --no-worker
+static int64_t s_sim_ms;
+static double s_face_ns;
+static double s_worker_ns;
+static uint32_t s_worker_lookups;
+
+static uint16_t prv_sim_clock(time_t *secs) {
+  *secs = (time_t)(s_sim_ms / 1000);
+  return (uint16_t)(s_sim_ms % 1000);
+}
+
+static double prv_now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Run the worker while there is something for it to do, and hand the face
+// whatever it sends back.  Without a worker there is nothing to time.
+static void prv_pump() {
+  if (!s_worker_on)
+    return;
+  for (;;) {
+    uint32_t lookups = pebble_host_trig_lookups;
+    double start = prv_now_ns();
+    int ran = pebble_host_run_worker();
+    s_worker_ns += prv_now_ns() - start;
+    s_worker_lookups += pebble_host_trig_lookups - lookups;
+    start = prv_now_ns();
+    ran += pebble_host_deliver_worker_messages();
+    s_face_ns += prv_now_ns() - start;
+    if (ran == 0)
+      return;
+  }
+}
+
+// Move the clock on by ms, firing the app timers at their due times
+static void prv_advance(uint32_t ms) {
+  uint32_t next;
+  while ((next = pebble_host_next_timer_ms()) <= ms) {
+    s_sim_ms += next;
+    ms -= next;
+    double start = prv_now_ns();
+    pebble_host_advance_timers(next);
+    s_face_ns += prv_now_ns() - start;
+    prv_pump();
+  }
+  s_sim_ms += ms;
+  pebble_host_advance_timers(ms);
+}
+
+static void prv_draw() {
+  double start = prv_now_ns();
+  pebble_host_render_dirty();
+  s_face_ns += prv_now_ns() - start;
+}
+
+int main(int argc, char **argv) {
+  s_worker_on = !((argc > 1) && (strcmp(argv[1], "--no-worker") == 0));
+  setenv("TZ", TIME_ZONE, 1);
+  tzset();
+  sky_clock_set_source(prv_sim_clock);
+  s_sim_ms = (int64_t)START * 1000;
+  if (s_worker_on)
+    pebble_host_worker_init = prv_init;
+
+  double start = prv_now_ns();
+  init();
+  double init_ms = (prv_now_ns() - start) / 1e6;
+  if (s_worker_on) {
+    DictionaryIterator *iter;
+    app_message_outbox_begin(&iter);
+    dict_write_int32(iter, MESSAGE_KEY_BackgroundWorker, 1);
+    pebble_host_deliver(iter);
+  }
+  prv_pump();
+  prv_draw();
+  printf("init %.2f ms, %d store fills, %s\n\n", init_ms, (int)s_sky_store_fills,
+         s_worker_on ? "with the worker" : "no worker");
+
+  printf("date        checks avoided  hit%%  fills  draws  timers  lookups   face ms  worker fills  ms\n");
+  uint32_t total_checks = 0, total_avoided = 0, total_fills = 0, total_draws = 0;
+  uint32_t total_worker_fills = 0;
+  double total_ns = 0, worst_ns = 0, total_worker_ns = 0;
+  for (int day = 0; day < DAYS; day++) {
+    uint32_t checks = s_sky_path_checks, avoided = s_sky_path_avoided, fills = s_sky_store_fills;
+    uint32_t draws = s_sky_cache.renders + s_sky_cache.blits, timers = pebble_host_timers_fired;
+    uint32_t lookups = pebble_host_trig_lookups, worker_lookups = s_worker_lookups;
+    uint32_t worker_fills = s_worker_fills;
+    s_face_ns = 0;
+    s_worker_ns = 0;
+    time_t midnight = (time_t)(s_sim_ms / 1000);
+
+    for (int minute = 0; minute < 24*60; minute++) {
+      prv_advance(60*1000);
+      time_t now = (time_t)(s_sim_ms / 1000);
+      start = prv_now_ns();
+      pebble_host_tick_handler(localtime(&now), MINUTE_UNIT);
+      s_face_ns += prv_now_ns() - start;
+      if (s_worker_on && (localtime(&now)->tm_min == 0)) {
+        uint32_t before = pebble_host_trig_lookups;
+        start = prv_now_ns();
+        pebble_host_tick_worker(localtime(&now), HOUR_UNIT | MINUTE_UNIT);
+        s_worker_ns += prv_now_ns() - start;
+        s_worker_lookups += pebble_host_trig_lookups - before;
+      }
+      prv_pump();
+      prv_draw();
+    }
+
+    checks = s_sky_path_checks - checks;
+    avoided = s_sky_path_avoided - avoided;
+    fills = s_sky_store_fills - fills;
+    draws = s_sky_cache.renders + s_sky_cache.blits - draws;
+    worker_fills = s_worker_fills - worker_fills;
+    worker_lookups = s_worker_lookups - worker_lookups;
+    char date[16];
+    strftime(date, sizeof(date), "%Y-%m-%d", localtime(&midnight));
+    printf("%s  %6d  %6d  %5.1f  %5d  %5d  %6d  %7d  %8.2f  %12d  %5.2f\n", date, (int)checks,
+           (int)avoided, checks ? 100.0 * avoided / checks : 0.0, (int)fills, (int)draws,
+           (int)(pebble_host_timers_fired - timers),
+           (int)(pebble_host_trig_lookups - lookups - worker_lookups), s_face_ns / 1e6,
+           (int)worker_fills, s_worker_ns / 1e6);
+    total_checks += checks;
+    total_avoided += avoided;
+    total_fills += fills;
+    total_draws += draws;
+    total_ns += s_face_ns;
+    total_worker_fills += worker_fills;
+    total_worker_ns += s_worker_ns;
+    if (s_face_ns > worst_ns) worst_ns = s_face_ns;
+  }
+
+  printf("\n%d days: %d checks, %d avoided (%.1f%%), %d store fills, %d draws, "
+         "%.2f ms face time a day on average, %.2f ms at most, %.0f lookups a day; "
+         "worker %d fills, %.2f ms a day on average\n",
+         DAYS, (int)total_checks, (int)total_avoided,
+         total_checks ? 100.0 * total_avoided / total_checks : 0.0, (int)total_fills,
+         (int)total_draws, total_ns / DAYS / 1e6, worst_ns / 1e6,
+         (double)(pebble_host_trig_lookups - s_worker_lookups) / DAYS,
+         (int)total_worker_fills, total_worker_ns / DAYS / 1e6);
+#if defined(SKY_PROFILE)
+  // host milliseconds, so mostly zeros; on the watch they are real
+  for (int i = 0; i < PROFILE_SECTIONS; i++) {
+    const ProfileStats *stats = profile_stats(i);
+    printf("profile %-5s %7d runs  %6d ms  max %3d ms\n", profile_name(i), (int)stats->count,
+           (int)stats->total_ms, (int)stats->max_ms);
+  }
+#endif
+  deinit();
+  if (s_worker_on)
+    prv_deinit();
+  return 0;
+}
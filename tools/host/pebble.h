@@ -0,0 +1,306 @@
+#pragma once
+//
+// Host stand-in for the parts of the Pebble SDK used by the ephemeris core.
+// Only meant for profiling and checking the astronomy on a desktop machine:
+//
+//   cc -O2 -I tools/host -I src/c ... tools/host/pebble_host.c -lm
+//
+// The app framework at the end (windows, layers, timers, messages) lets
+// main.c itself build on the host; link tools/host/pebble_app_host.c too
+// when using it.
+//
+// The integer trig lookups follow the SDK contract (angles in
+// TRIG_MAX_ANGLE units, results scaled by TRIG_MAX_RATIO) and are table
+// driven like the firmware, so relative costs stay meaningful.
+//
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define TRIG_MAX_RATIO 0xffff
+#define TRIG_MAX_ANGLE 0x10000
+
+int32_t sin_lookup(int32_t angle);
+int32_t cos_lookup(int32_t angle);
+int32_t atan2_lookup(int16_t y, int16_t x);
+
+// host only: number of trig lookups made so far, a timing-free cost measure
+extern uint32_t pebble_host_trig_lookups;
+
+// persistent storage, kept in memory and lost when the process exits
+#define PERSIST_DATA_MAX_LENGTH 256
+#define E_DOES_NOT_EXIST -9
+bool persist_exists(uint32_t key);
+int persist_read_data(uint32_t key, void *buffer, size_t buffer_size);
+int persist_write_data(uint32_t key, const void *data, size_t size);
+int persist_delete(uint32_t key);
+
+// host only: number of persist_write_data calls, each one a flash write on the watch
+extern uint32_t pebble_host_persist_writes;
+
+typedef struct GPoint {
+  int16_t x;
+  int16_t y;
+} GPoint;
+#define GPoint(x, y) ((GPoint){(x), (y)})
+
+typedef struct GSize {
+  int16_t w;
+  int16_t h;
+} GSize;
+
+typedef struct GRect {
+  GPoint origin;
+  GSize size;
+} GRect;
+#define GRect(x, y, w, h) ((GRect){{(x), (y)}, {(w), (h)}})
+
+// drawing, into a host frame buffer of the largest watch screen
+typedef struct GContext GContext;
+typedef uint8_t GColor;
+#define GColorBlack ((GColor)0x00)
+#define GColorWhite ((GColor)0xff)
+// a few of the 64 colours, as the firmware's argb bytes
+#define GColorOxfordBlue ((GColor)0xc1)
+#define GColorDukeBlue ((GColor)0xc2)
+#define GColorCobaltBlue ((GColor)0xc6)
+#define GColorVividCerulean ((GColor)0xcb)
+void graphics_context_set_stroke_color(GContext *ctx, GColor color);
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1);
+void graphics_context_set_fill_color(GContext *ctx, GColor color);
+typedef enum { GCornerNone = 0, GCornersAll = 15 } GCornerMask;
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask);
+void graphics_draw_circle(GContext *ctx, GPoint p, uint16_t radius);
+typedef enum { GOvalScaleModeFitCircle, GOvalScaleModeFillCircle } GOvalScaleMode;
+// angles clockwise from 12 o'clock; only the circle mode is drawn
+void graphics_fill_radial(GContext *ctx, GRect rect, GOvalScaleMode scale_mode, uint16_t inset_thickness,
+                          int32_t angle_start, int32_t angle_end);
+
+// host only: the frame buffer, and the draw calls and pixels written so far
+#define PEBBLE_HOST_SCREEN_W 200
+#define PEBBLE_HOST_SCREEN_H 228
+extern GColor pebble_host_frame[PEBBLE_HOST_SCREEN_H][PEBBLE_HOST_SCREEN_W];
+extern uint32_t pebble_host_draw_calls;
+extern uint32_t pebble_host_pixels_drawn;
+
+typedef enum {
+  APP_LOG_LEVEL_ERROR = 1,
+  APP_LOG_LEVEL_WARNING = 50,
+  APP_LOG_LEVEL_INFO = 100,
+  APP_LOG_LEVEL_DEBUG = 200,
+  APP_LOG_LEVEL_DEBUG_VERBOSE = 255,
+} AppLogLevel;
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...);
+
+// logging is silent unless asked for, it would swamp any timing.  The
+// face's own sources also need SKY_LOGGING, see profile.h.
+#ifdef PEBBLE_HOST_VERBOSE
+#define APP_LOG(level, fmt, ...) \
+  fprintf(stderr, "[%d] %s:%d " fmt "\n", (int)(level), __FILE__, __LINE__, ##__VA_ARGS__)
+#else
+#define APP_LOG(level, fmt, ...) \
+  do { if (0) fprintf(stderr, fmt, ##__VA_ARGS__); } while (0)
+#endif
+
+// build with -DPBL_ROUND to stand in for chalk
+#if defined(PBL_ROUND)
+#define PBL_IF_ROUND_ELSE(if_true, if_false) (if_true)
+#else
+#define PBL_IF_ROUND_ELSE(if_true, if_false) (if_false)
+#endif
+#if defined(PBL_BW)
+#define PBL_IF_BW_ELSE(if_true, if_false) (if_true)
+#else
+#define PBL_IF_BW_ELSE(if_true, if_false) (if_false)
+#endif
+
+//
+// App framework.  Nothing is shown: layers only remember their update proc
+// and whether they are dirty, text layers their text, and timers fire
+// when the host says time has passed.
+//
+
+#define GSize(w, h) ((GSize){(w), (h)})
+#define GColorClear ((GColor)0x00)
+
+typedef enum { GCompOpAssign, GCompOpAssignInverted, GCompOpOr, GCompOpAnd, GCompOpClear, GCompOpSet } GCompOp;
+typedef enum { GTextAlignmentLeft, GTextAlignmentCenter, GTextAlignmentRight } GTextAlignment;
+typedef enum { GBitmapFormat1Bit, GBitmapFormat8Bit } GBitmapFormat;
+
+typedef struct GBitmap GBitmap;
+typedef struct {
+  uint8_t *data;
+  int16_t min_x;
+  int16_t max_x;
+} GBitmapDataRowInfo;
+
+GBitmap *gbitmap_create_with_resource(uint32_t resource_id);
+GBitmap *gbitmap_create_blank(GSize size, GBitmapFormat format);
+GBitmap *gbitmap_create_as_sub_bitmap(const GBitmap *parent, GRect sub_rect);
+void gbitmap_destroy(GBitmap *bitmap);
+uint8_t *gbitmap_get_data(const GBitmap *bitmap);
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap);
+GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap *bitmap, uint16_t y);
+
+// the frame buffer handed out is pebble_host_frame
+GBitmap *graphics_capture_frame_buffer(GContext *ctx);
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer);
+void graphics_context_set_stroke_width(GContext *ctx, uint8_t width);
+void graphics_context_set_compositing_mode(GContext *ctx, GCompOp mode);
+// counted as a draw call of w * h pixels, nothing is copied
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect);
+
+typedef struct Layer Layer;
+typedef void (*LayerUpdateProc)(Layer *layer, GContext *ctx);
+Layer *layer_create(GRect frame);
+void layer_destroy(Layer *layer);
+GRect layer_get_bounds(const Layer *layer);
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc);
+void layer_add_child(Layer *parent, Layer *child);
+void layer_mark_dirty(Layer *layer);
+
+typedef struct GFont *GFont;
+#define FONT_KEY_BITHAM_42_BOLD "RESOURCE_ID_BITHAM_42_BOLD"
+#define FONT_KEY_GOTHIC_24_BOLD "RESOURCE_ID_GOTHIC_24_BOLD"
+GFont fonts_get_system_font(const char *font_key);
+
+typedef struct TextLayer TextLayer;
+TextLayer *text_layer_create(GRect frame);
+void text_layer_destroy(TextLayer *text_layer);
+Layer *text_layer_get_layer(TextLayer *text_layer);
+void text_layer_set_text(TextLayer *text_layer, const char *text);
+void text_layer_set_font(TextLayer *text_layer, GFont font);
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment);
+void text_layer_set_background_color(TextLayer *text_layer, GColor color);
+void text_layer_set_text_color(TextLayer *text_layer, GColor color);
+
+typedef struct Window Window;
+typedef void (*WindowHandler)(Window *window);
+typedef struct {
+  WindowHandler load;
+  WindowHandler appear;
+  WindowHandler disappear;
+  WindowHandler unload;
+} WindowHandlers;
+Window *window_create(void);
+void window_destroy(Window *window);  // unloads it if loaded
+void window_set_window_handlers(Window *window, WindowHandlers handlers);
+void window_set_background_color(Window *window, GColor color);
+Layer *window_get_root_layer(const Window *window);
+void window_stack_push(Window *window, bool animated);  // loads it
+
+typedef struct AppTimer AppTimer;
+typedef void (*AppTimerCallback)(void *data);
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data);
+bool app_timer_reschedule(AppTimer *timer_handle, uint32_t new_timeout_ms);
+void app_timer_cancel(AppTimer *timer_handle);
+
+typedef enum { SECOND_UNIT = 1, MINUTE_UNIT = 2, HOUR_UNIT = 4, DAY_UNIT = 8 } TimeUnits;
+typedef void (*TickHandler)(struct tm *tick_time, TimeUnits units_changed);
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler);
+
+typedef enum { ACCEL_AXIS_X, ACCEL_AXIS_Y, ACCEL_AXIS_Z } AccelAxisType;
+typedef void (*AccelTapHandler)(AccelAxisType axis, int32_t direction);
+void accel_tap_service_subscribe(AccelTapHandler handler);
+
+// the wall clock, as on the watch
+uint16_t time_ms(time_t *t_utc, uint16_t *out_ms);
+bool clock_is_24h_style(void);
+void app_event_loop(void);
+
+// Messages.  Tuples hold int32 values or up to PEBBLE_HOST_TUPLE_DATA bytes.
+#define PEBBLE_HOST_TUPLE_DATA 124
+#define PEBBLE_HOST_DICT_TUPLES 8
+typedef struct {
+  uint32_t key;
+  uint8_t type;
+  uint16_t length;
+  union {
+    uint8_t data[PEBBLE_HOST_TUPLE_DATA];
+    int32_t int32;
+  } value[1];
+} Tuple;
+typedef struct DictionaryIterator {
+  int count;
+  Tuple tuples[PEBBLE_HOST_DICT_TUPLES];
+} DictionaryIterator;
+typedef enum { DICT_OK = 0, DICT_NOT_ENOUGH_STORAGE = 2 } DictionaryResult;
+typedef enum { APP_MSG_OK = 0, APP_MSG_NOT_CONNECTED = 8 } AppMessageResult;
+typedef void (*AppMessageInboxReceived)(DictionaryIterator *iterator, void *context);
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key);
+DictionaryResult dict_write_int32(DictionaryIterator *iter, const uint32_t key, const int32_t value);
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound);
+void app_message_register_inbox_received(AppMessageInboxReceived received_callback);
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator);
+AppMessageResult app_message_outbox_send(void);
+// no phone on the host
+bool connection_service_peek_pebble_app_connection(void);
+
+// The background worker and its messages to and from the app
+typedef struct {
+  uint16_t data0;
+  uint16_t data1;
+  uint16_t data2;
+} AppWorkerMessage;
+typedef enum {
+  APP_WORKER_RESULT_SUCCESS = 0,
+  APP_WORKER_RESULT_NO_WORKER = 1,
+  APP_WORKER_RESULT_DIFFERENT_APP = 2,
+  APP_WORKER_RESULT_NOT_RUNNING = 3,
+  APP_WORKER_RESULT_ALREADY_RUNNING = 4,
+  APP_WORKER_RESULT_ASKING_CONFIRMATION = 5,
+} AppWorkerResult;
+typedef void (*AppWorkerMessageHandler)(uint16_t type, AppWorkerMessage *data);
+bool app_worker_is_running(void);
+AppWorkerResult app_worker_launch(void);
+AppWorkerResult app_worker_kill(void);
+bool app_worker_message_subscribe(AppWorkerMessageHandler handler);
+bool app_worker_message_unsubscribe(void);
+void app_worker_send_message(uint8_t type, AppWorkerMessage *data);
+void worker_event_loop(void);
+
+// The keys the SDK generates from package.json and resources
+extern uint32_t MESSAGE_KEY_Latitude;
+extern uint32_t MESSAGE_KEY_Longitude;
+extern uint32_t MESSAGE_KEY_ShowInfo;
+extern uint32_t MESSAGE_KEY_Dayshift;
+extern uint32_t MESSAGE_KEY_PhoneLatitude;
+extern uint32_t MESSAGE_KEY_PhoneLongitude;
+extern uint32_t MESSAGE_KEY_SkyRequest;
+extern uint32_t MESSAGE_KEY_SkyLatitude;
+extern uint32_t MESSAGE_KEY_SkyLongitude;
+extern uint32_t MESSAGE_KEY_SkyBody;
+extern uint32_t MESSAGE_KEY_SkyRow;
+extern uint32_t MESSAGE_KEY_SkyData;
+extern uint32_t MESSAGE_KEY_BackgroundWorker;
+#define RESOURCE_ID_IMAGE_SKY_ATLAS 1
+
+// host only: timers, dirty layers and messages, driven by a harness
+// Milliseconds until the next timer is due, or UINT32_MAX if none is set
+uint32_t pebble_host_next_timer_ms(void);
+// Move timer time on by ms, firing every timer that falls due, in order
+void pebble_host_advance_timers(uint32_t ms);
+// Run the update proc of every dirty layer; returns how many ran
+int pebble_host_render_dirty(void);
+// Hand a message to the registered inbox handler
+void pebble_host_deliver(DictionaryIterator *iter);
+// The handlers main.c subscribed
+extern TickHandler pebble_host_tick_handler;
+extern AccelTapHandler pebble_host_tap_handler;
+extern uint32_t pebble_host_timers_fired;
+// The worker runs in the harness's process.  The harness sets its init
+// function (none: no worker, and app_worker_launch() fails); a launch
+// queues it to start.  While pebble_host_in_worker is set, subscriptions
+// and messages sent are the worker's.
+extern void (*pebble_host_worker_init)(void);
+extern bool pebble_host_in_worker;
+// Start a launched worker and hand it the messages the app sent; then hand
+// the app the worker's.  Each returns how many ran.
+int pebble_host_run_worker(void);
+int pebble_host_deliver_worker_messages(void);
+// Run the tick handler the worker subscribed, if it did
+void pebble_host_tick_worker(struct tm *tick_time, TimeUnits units_changed);
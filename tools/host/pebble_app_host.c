@@ -0,0 +1,462 @@
+#include <pebble.h>
+#include <stdlib.h>
+//
+// Host implementations of the app framework, enough to run main.c under a
+// harness.  Nothing reaches a screen or a phone.
+//
+
+uint32_t MESSAGE_KEY_Latitude = 10000;
+uint32_t MESSAGE_KEY_Longitude = 10001;
+uint32_t MESSAGE_KEY_ShowInfo = 10002;
+uint32_t MESSAGE_KEY_Dayshift = 10003;
+uint32_t MESSAGE_KEY_PhoneLatitude = 10004;
+uint32_t MESSAGE_KEY_PhoneLongitude = 10005;
+uint32_t MESSAGE_KEY_SkyRequest = 10006;
+uint32_t MESSAGE_KEY_SkyLatitude = 10007;
+uint32_t MESSAGE_KEY_SkyLongitude = 10008;
+uint32_t MESSAGE_KEY_SkyBody = 10009;
+uint32_t MESSAGE_KEY_SkyRow = 10010;
+uint32_t MESSAGE_KEY_SkyData = 10011;
+uint32_t MESSAGE_KEY_BackgroundWorker = 10012;
+
+// Bitmaps: blank ones own their pixels, sub-bitmaps point into the parent's
+
+struct GBitmap {
+  GSize size;
+  uint16_t stride;
+  uint8_t *data;
+  bool owns_data;
+};
+
+// the sky atlas made by tools/atlas/make_sky_atlas.py
+#define ATLAS_W 34
+#define ATLAS_H 28
+
+static GBitmap *prv_bitmap(GSize size, uint16_t stride, uint8_t *data) {
+  GBitmap *bitmap = calloc(1, sizeof(GBitmap));
+  bitmap->size = size;
+  bitmap->stride = stride;
+  bitmap->data = data;
+  if (data == NULL) {
+    bitmap->data = calloc((size_t)stride * size.h, 1);
+    bitmap->owns_data = true;
+  }
+  return bitmap;
+}
+
+GBitmap *gbitmap_create_with_resource(uint32_t resource_id) {
+  if (resource_id != RESOURCE_ID_IMAGE_SKY_ATLAS) return NULL;
+  return prv_bitmap(GSize(ATLAS_W, ATLAS_H), ATLAS_W, NULL);
+}
+
+GBitmap *gbitmap_create_blank(GSize size, GBitmapFormat format) {
+  uint16_t stride = (format == GBitmapFormat1Bit) ? ((size.w + 31) / 32) * 4 : size.w;
+  return prv_bitmap(size, stride, NULL);
+}
+
+GBitmap *gbitmap_create_as_sub_bitmap(const GBitmap *parent, GRect sub_rect) {
+  return prv_bitmap(sub_rect.size, parent->stride,
+                    parent->data + sub_rect.origin.y * parent->stride + sub_rect.origin.x);
+}
+
+void gbitmap_destroy(GBitmap *bitmap) {
+  if (bitmap == NULL) return;
+  if (bitmap->owns_data) free(bitmap->data);
+  free(bitmap);
+}
+
+uint8_t *gbitmap_get_data(const GBitmap *bitmap) {
+  return bitmap->data;
+}
+
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap) {
+  return bitmap->stride;
+}
+
+GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap *bitmap, uint16_t y) {
+  return (GBitmapDataRowInfo){ bitmap->data + y * bitmap->stride, 0, bitmap->size.w - 1 };
+}
+
+static GBitmap s_frame_buffer = {
+  { PEBBLE_HOST_SCREEN_W, PEBBLE_HOST_SCREEN_H }, PEBBLE_HOST_SCREEN_W, &pebble_host_frame[0][0], false
+};
+
+GBitmap *graphics_capture_frame_buffer(GContext *ctx) {
+  return &s_frame_buffer;
+}
+
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer) {
+  return true;
+}
+
+void graphics_context_set_stroke_width(GContext *ctx, uint8_t width) {}
+void graphics_context_set_compositing_mode(GContext *ctx, GCompOp mode) {}
+
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect) {
+  pebble_host_draw_calls++;
+  pebble_host_pixels_drawn += rect.size.w * rect.size.h;
+}
+
+// Layers
+
+#define MAX_LAYERS 16
+
+struct Layer {
+  GRect frame;
+  LayerUpdateProc update_proc;
+  bool dirty;
+};
+
+static Layer *s_layers[MAX_LAYERS];
+
+Layer *layer_create(GRect frame) {
+  Layer *layer = calloc(1, sizeof(Layer));
+  layer->frame = frame;
+  for (int i = 0; i < MAX_LAYERS; i++) {
+    if (s_layers[i] == NULL) {
+      s_layers[i] = layer;
+      break;
+    }
+  }
+  return layer;
+}
+
+void layer_destroy(Layer *layer) {
+  for (int i = 0; i < MAX_LAYERS; i++)
+    if (s_layers[i] == layer) s_layers[i] = NULL;
+  free(layer);
+}
+
+GRect layer_get_bounds(const Layer *layer) {
+  return GRect(0, 0, layer->frame.size.w, layer->frame.size.h);
+}
+
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc) {
+  layer->update_proc = update_proc;
+}
+
+void layer_add_child(Layer *parent, Layer *child) {}
+
+void layer_mark_dirty(Layer *layer) {
+  layer->dirty = true;
+}
+
+int pebble_host_render_dirty(void) {
+  int rendered = 0;
+  for (int i = 0; i < MAX_LAYERS; i++) {
+    Layer *layer = s_layers[i];
+    if ((layer == NULL) || !layer->dirty) continue;
+    layer->dirty = false;
+    if (layer->update_proc) {
+      layer->update_proc(layer, NULL);
+      rendered++;
+    }
+  }
+  return rendered;
+}
+
+GFont fonts_get_system_font(const char *font_key) {
+  return NULL;
+}
+
+struct TextLayer {
+  Layer *layer;
+  const char *text;
+};
+
+TextLayer *text_layer_create(GRect frame) {
+  TextLayer *text_layer = calloc(1, sizeof(TextLayer));
+  text_layer->layer = layer_create(frame);
+  return text_layer;
+}
+
+void text_layer_destroy(TextLayer *text_layer) {
+  layer_destroy(text_layer->layer);
+  free(text_layer);
+}
+
+Layer *text_layer_get_layer(TextLayer *text_layer) {
+  return text_layer->layer;
+}
+
+void text_layer_set_text(TextLayer *text_layer, const char *text) {
+  text_layer->text = text;
+}
+
+void text_layer_set_font(TextLayer *text_layer, GFont font) {}
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment) {}
+void text_layer_set_background_color(TextLayer *text_layer, GColor color) {}
+void text_layer_set_text_color(TextLayer *text_layer, GColor color) {}
+
+// Windows: one screen the size of the largest rectangular watch
+
+struct Window {
+  Layer *root;
+  WindowHandlers handlers;
+  bool loaded;
+};
+
+Window *window_create(void) {
+  Window *window = calloc(1, sizeof(Window));
+  window->root = layer_create(GRect(0, 0, 144, 168));
+  return window;
+}
+
+void window_destroy(Window *window) {
+  if (window->loaded && window->handlers.unload)
+    window->handlers.unload(window);
+  layer_destroy(window->root);
+  free(window);
+}
+
+void window_set_window_handlers(Window *window, WindowHandlers handlers) {
+  window->handlers = handlers;
+}
+
+void window_set_background_color(Window *window, GColor color) {}
+
+Layer *window_get_root_layer(const Window *window) {
+  return window->root;
+}
+
+void window_stack_push(Window *window, bool animated) {
+  if (!window->loaded && window->handlers.load)
+    window->handlers.load(window);
+  window->loaded = true;
+}
+
+// Timers count down host milliseconds given by pebble_host_advance_timers()
+
+#define MAX_TIMERS 8
+
+struct AppTimer {
+  bool active;
+  uint32_t due_ms;
+  AppTimerCallback callback;
+  void *data;
+};
+
+static AppTimer s_timers[MAX_TIMERS];
+static uint32_t s_timer_now_ms = 0;
+uint32_t pebble_host_timers_fired = 0;
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data) {
+  for (int i = 0; i < MAX_TIMERS; i++) {
+    if (!s_timers[i].active) {
+      s_timers[i] = (AppTimer){ true, s_timer_now_ms + timeout_ms, callback, callback_data };
+      return &s_timers[i];
+    }
+  }
+  return NULL;
+}
+
+bool app_timer_reschedule(AppTimer *timer_handle, uint32_t new_timeout_ms) {
+  if (!timer_handle->active) return false;
+  timer_handle->due_ms = s_timer_now_ms + new_timeout_ms;
+  return true;
+}
+
+void app_timer_cancel(AppTimer *timer_handle) {
+  timer_handle->active = false;
+}
+
+uint32_t pebble_host_next_timer_ms(void) {
+  uint32_t next = UINT32_MAX;
+  for (int i = 0; i < MAX_TIMERS; i++) {
+    if (s_timers[i].active && (s_timers[i].due_ms - s_timer_now_ms < next))
+      next = s_timers[i].due_ms - s_timer_now_ms;
+  }
+  return next;
+}
+
+void pebble_host_advance_timers(uint32_t ms) {
+  uint32_t end = s_timer_now_ms + ms;
+  uint32_t next;
+  while ((next = pebble_host_next_timer_ms()) <= end - s_timer_now_ms) {
+    s_timer_now_ms += next;
+    for (int i = 0; i < MAX_TIMERS; i++) {
+      AppTimer *timer = &s_timers[i];
+      if (timer->active && (timer->due_ms == s_timer_now_ms)) {
+        timer->active = false;  // a one shot, free for the callback to reuse
+        pebble_host_timers_fired++;
+        timer->callback(timer->data);
+      }
+    }
+  }
+  s_timer_now_ms = end;
+}
+
+TickHandler pebble_host_tick_handler = NULL;
+static TickHandler s_worker_tick_handler = NULL;
+AccelTapHandler pebble_host_tap_handler = NULL;
+bool pebble_host_in_worker = false;
+
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler) {
+  if (pebble_host_in_worker)
+    s_worker_tick_handler = handler;
+  else
+    pebble_host_tick_handler = handler;
+}
+
+void accel_tap_service_subscribe(AccelTapHandler handler) {
+  pebble_host_tap_handler = handler;
+}
+
+uint16_t time_ms(time_t *t_utc, uint16_t *out_ms) {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  uint16_t ms = (uint16_t)(ts.tv_nsec / 1000000);
+  if (t_utc) *t_utc = ts.tv_sec;
+  if (out_ms) *out_ms = ms;
+  return ms;
+}
+
+bool clock_is_24h_style(void) {
+  return true;
+}
+
+void app_event_loop(void) {}
+
+// Messages
+
+static AppMessageInboxReceived s_inbox_received = NULL;
+static DictionaryIterator s_outbox;
+
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key) {
+  for (int i = 0; i < iter->count; i++)
+    if (iter->tuples[i].key == key) return (Tuple *)&iter->tuples[i];
+  return NULL;
+}
+
+DictionaryResult dict_write_int32(DictionaryIterator *iter, const uint32_t key, const int32_t value) {
+  if (iter->count >= PEBBLE_HOST_DICT_TUPLES) return DICT_NOT_ENOUGH_STORAGE;
+  Tuple *tuple = &iter->tuples[iter->count++];
+  tuple->key = key;
+  tuple->type = 3;  // TUPLE_INT
+  tuple->length = sizeof(int32_t);
+  tuple->value->int32 = value;
+  return DICT_OK;
+}
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound) {
+  return APP_MSG_OK;
+}
+
+void app_message_register_inbox_received(AppMessageInboxReceived received_callback) {
+  s_inbox_received = received_callback;
+}
+
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator) {
+  s_outbox.count = 0;
+  *iterator = &s_outbox;
+  return APP_MSG_OK;
+}
+
+AppMessageResult app_message_outbox_send(void) {
+  return APP_MSG_NOT_CONNECTED;
+}
+
+bool connection_service_peek_pebble_app_connection(void) {
+  return false;
+}
+
+void pebble_host_deliver(DictionaryIterator *iter) {
+  if (s_inbox_received) s_inbox_received(iter, NULL);
+}
+
+// The worker: one queue of messages each way, run when the harness says
+
+#define MAX_WORKER_MESSAGES 8
+
+typedef struct {
+  uint8_t type;
+  AppWorkerMessage data;
+} WorkerMessage;
+
+typedef struct {
+  AppWorkerMessageHandler handler;
+  WorkerMessage queue[MAX_WORKER_MESSAGES];
+  int count;
+} WorkerSide;
+
+static WorkerSide s_worker_sides[2];  // the app's, then the worker's
+static bool s_worker_launched = false;
+static bool s_worker_started = false;
+void (*pebble_host_worker_init)(void) = NULL;
+
+bool app_worker_is_running(void) {
+  return s_worker_launched;
+}
+
+AppWorkerResult app_worker_launch(void) {
+  if (pebble_host_worker_init == NULL) return APP_WORKER_RESULT_NO_WORKER;
+  if (s_worker_launched) return APP_WORKER_RESULT_ALREADY_RUNNING;
+  s_worker_launched = true;
+  return APP_WORKER_RESULT_SUCCESS;
+}
+
+// the worker's state stays as it was, as if it were launched again later
+AppWorkerResult app_worker_kill(void) {
+  if (!s_worker_launched) return APP_WORKER_RESULT_NOT_RUNNING;
+  s_worker_launched = false;
+  s_worker_started = false;
+  s_worker_sides[1].count = 0;
+  return APP_WORKER_RESULT_SUCCESS;
+}
+
+bool app_worker_message_subscribe(AppWorkerMessageHandler handler) {
+  s_worker_sides[pebble_host_in_worker].handler = handler;
+  return true;
+}
+
+bool app_worker_message_unsubscribe(void) {
+  s_worker_sides[pebble_host_in_worker].handler = NULL;
+  return true;
+}
+
+// queued for the other side; dropped if it is full, as the watch drops them
+void app_worker_send_message(uint8_t type, AppWorkerMessage *data) {
+  WorkerSide *to = &s_worker_sides[!pebble_host_in_worker];
+  if (to->count < MAX_WORKER_MESSAGES)
+    to->queue[to->count++] = (WorkerMessage){ type, *data };
+}
+
+void worker_event_loop(void) {}
+
+static int prv_deliver(bool to_worker) {
+  WorkerSide *side = &s_worker_sides[to_worker];
+  int delivered = 0;
+  pebble_host_in_worker = to_worker;
+  while (side->count > 0) {
+    WorkerMessage message = side->queue[0];
+    side->count--;
+    memmove(&side->queue[0], &side->queue[1], side->count * sizeof(WorkerMessage));
+    if (side->handler) side->handler(message.type, &message.data);
+    delivered++;
+  }
+  pebble_host_in_worker = false;
+  return delivered;
+}
+
+int pebble_host_run_worker(void) {
+  int ran = 0;
+  if (s_worker_launched && !s_worker_started) {
+    s_worker_started = true;
+    pebble_host_in_worker = true;
+    pebble_host_worker_init();
+    pebble_host_in_worker = false;
+    ran++;
+  }
+  return ran + prv_deliver(true);
+}
+
+int pebble_host_deliver_worker_messages(void) {
+  return prv_deliver(false);
+}
+
+void pebble_host_tick_worker(struct tm *tick_time, TimeUnits units_changed) {
+  if (s_worker_tick_handler == NULL) return;
+  pebble_host_in_worker = true;
+  s_worker_tick_handler(tick_time, units_changed);
+  pebble_host_in_worker = false;
+}
@@ -0,0 +1,181 @@
+#include <pebble.h>
+#include <stdlib.h>
+#include <math.h>
+#include <stdarg.h>
+//
+// Host implementations of the Pebble integer trig lookups, storage and drawing
+//
+
+#define QUARTER_TURN (TRIG_MAX_ANGLE / 4)
+
+uint32_t pebble_host_trig_lookups = 0;
+
+static int32_t s_sin_table[QUARTER_TURN + 1];
+static bool s_sin_table_ready = false;
+
+static void prv_build_sin_table() {
+  for (int i = 0; i <= QUARTER_TURN; i++) {
+    s_sin_table[i] = (int32_t)lround(sin(2 * M_PI * i / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO);
+  }
+  s_sin_table_ready = true;
+}
+
+int32_t sin_lookup(int32_t angle) {
+  if (!s_sin_table_ready) prv_build_sin_table();
+  pebble_host_trig_lookups++;
+  int32_t a = angle & (TRIG_MAX_ANGLE - 1);
+  if (a < QUARTER_TURN) return s_sin_table[a];
+  if (a < 2 * QUARTER_TURN) return s_sin_table[2 * QUARTER_TURN - a];
+  if (a < 3 * QUARTER_TURN) return -s_sin_table[a - 2 * QUARTER_TURN];
+  return -s_sin_table[TRIG_MAX_ANGLE - a];
+}
+
+int32_t cos_lookup(int32_t angle) {
+  return sin_lookup(angle + QUARTER_TURN);
+}
+
+int32_t atan2_lookup(int16_t y, int16_t x) {
+  // firmware returns the angle in the range 0 to TRIG_MAX_ANGLE
+  pebble_host_trig_lookups++;
+  double a = atan2((double)y, (double)x);
+  if (a < 0) a += 2 * M_PI;
+  return (int32_t)(a * TRIG_MAX_ANGLE / (2 * M_PI)) & (TRIG_MAX_ANGLE - 1);
+}
+
+#define PERSIST_KEYS 64
+
+typedef struct {
+  bool exists;
+  size_t size;
+  uint8_t data[PERSIST_DATA_MAX_LENGTH];
+} PersistEntry;
+
+uint32_t pebble_host_persist_writes = 0;
+
+static PersistEntry s_persist[PERSIST_KEYS];
+
+bool persist_exists(uint32_t key) {
+  return (key < PERSIST_KEYS) && s_persist[key].exists;
+}
+
+int persist_read_data(uint32_t key, void *buffer, size_t buffer_size) {
+  if (!persist_exists(key)) return E_DOES_NOT_EXIST;
+  size_t size = (buffer_size < s_persist[key].size) ? buffer_size : s_persist[key].size;
+  memcpy(buffer, s_persist[key].data, size);
+  return (int)size;
+}
+
+int persist_write_data(uint32_t key, const void *data, size_t size) {
+  if (key >= PERSIST_KEYS) return E_DOES_NOT_EXIST;
+  if (size > PERSIST_DATA_MAX_LENGTH) size = PERSIST_DATA_MAX_LENGTH;
+  pebble_host_persist_writes++;
+  memcpy(s_persist[key].data, data, size);
+  s_persist[key].size = size;
+  s_persist[key].exists = true;
+  return (int)size;
+}
+
+int persist_delete(uint32_t key) {
+  if (!persist_exists(key)) return E_DOES_NOT_EXIST;
+  s_persist[key].exists = false;
+  return 0;
+}
+
+GColor pebble_host_frame[PEBBLE_HOST_SCREEN_H][PEBBLE_HOST_SCREEN_W];
+uint32_t pebble_host_draw_calls = 0;
+uint32_t pebble_host_pixels_drawn = 0;
+
+static GColor s_stroke_color = GColorWhite;
+static GColor s_fill_color = GColorWhite;
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color) {
+  s_stroke_color = color;
+}
+
+static void prv_plot(int x, int y) {
+  pebble_host_pixels_drawn++;
+  if ((x >= 0) && (x < PEBBLE_HOST_SCREEN_W) && (y >= 0) && (y < PEBBLE_HOST_SCREEN_H))
+    pebble_host_frame[y][x] = s_stroke_color;
+}
+
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1) {
+  pebble_host_draw_calls++;
+  // Bresenham, both end points included like the firmware
+  int x = p0.x, y = p0.y;
+  int dx = abs(p1.x - p0.x), dy = -abs(p1.y - p0.y);
+  int sx = (p0.x < p1.x) ? 1 : -1, sy = (p0.y < p1.y) ? 1 : -1;
+  int err = dx + dy;
+  while (true) {
+    prv_plot(x, y);
+    if ((x == p1.x) && (y == p1.y)) break;
+    int e2 = 2 * err;
+    if (e2 >= dy) { err += dy; x += sx; }
+    if (e2 <= dx) { err += dx; y += sy; }
+  }
+}
+
+void graphics_context_set_fill_color(GContext *ctx, GColor color) {
+  s_fill_color = color;
+}
+
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask) {
+  pebble_host_draw_calls++;
+  for (int y = rect.origin.y; y < rect.origin.y + rect.size.h; y++)
+    for (int x = rect.origin.x; x < rect.origin.x + rect.size.w; x++) {
+      pebble_host_pixels_drawn++;
+      if ((x >= 0) && (x < PEBBLE_HOST_SCREEN_W) && (y >= 0) && (y < PEBBLE_HOST_SCREEN_H))
+        pebble_host_frame[y][x] = s_fill_color;
+    }
+}
+
+void graphics_draw_circle(GContext *ctx, GPoint p, uint16_t radius) {
+  pebble_host_draw_calls++;
+  // midpoint circle, eight octants at a time
+  int x = radius, y = 0, err = 1 - x;
+  while (x >= y) {
+    prv_plot(p.x + x, p.y + y); prv_plot(p.x - x, p.y + y);
+    prv_plot(p.x + x, p.y - y); prv_plot(p.x - x, p.y - y);
+    prv_plot(p.x + y, p.y + x); prv_plot(p.x - y, p.y + x);
+    prv_plot(p.x + y, p.y - x); prv_plot(p.x - y, p.y - x);
+    y++;
+    if (err < 0) {
+      err += 2*y + 1;
+    }
+    else {
+      x--;
+      err += 2*(y - x) + 1;
+    }
+  }
+}
+
+void graphics_fill_radial(GContext *ctx, GRect rect, GOvalScaleMode scale_mode, uint16_t inset_thickness,
+                          int32_t angle_start, int32_t angle_end) {
+  pebble_host_draw_calls++;
+  int size = (rect.size.w < rect.size.h) ? rect.size.w : rect.size.h;
+  double cx = rect.origin.x + rect.size.w / 2.0, cy = rect.origin.y + rect.size.h / 2.0;
+  double outer = size / 2.0, inner = outer - inset_thickness;
+  for (int y = rect.origin.y; y < rect.origin.y + rect.size.h; y++)
+    for (int x = rect.origin.x; x < rect.origin.x + rect.size.w; x++) {
+      double dx = x + 0.5 - cx, dy = y + 0.5 - cy;
+      double r = sqrt(dx*dx + dy*dy);
+      if ((r > outer) || (r < inner))
+        continue;
+      // clockwise from 12 o'clock, taken past angle_start
+      int32_t angle = (int32_t)(atan2(dx, -dy) / (2*M_PI) * TRIG_MAX_ANGLE);
+      while (angle < angle_start) angle += TRIG_MAX_ANGLE;
+      if (angle >= angle_end)
+        continue;
+      pebble_host_pixels_drawn++;
+      if ((x >= 0) && (x < PEBBLE_HOST_SCREEN_W) && (y >= 0) && (y < PEBBLE_HOST_SCREEN_H))
+        pebble_host_frame[y][x] = s_fill_color;
+    }
+}
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  fprintf(stderr, "[%d] %s:%d ", (int)log_level, src_filename, src_line_number);
+  vfprintf(stderr, fmt, args);
+  fputc('\n', stderr);
+  va_end(args);
+}
@@ -0,0 +1,7 @@
+#pragma once
+//
+// Host stand-in for the worker SDK header.  The host has one SDK, so this
+// is pebble.h; the worker build's restrictions are only checked by the
+// real SDK.
+//
+#include "pebble.h"
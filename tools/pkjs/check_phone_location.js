@@ -0,0 +1,104 @@
+// Exercise src/pkjs/phone_location.js under node with a mock Pebble object
+// and localStorage.
+//
+// Run from the repository root:
+//
+//   node tools/pkjs/check_phone_location.js
+//
+// A day of fixes every 15 minutes (as index.js polls) is replayed: GPS
+// jitter of a few hundredths of a degree at home, a drive of two degrees
+// and back, and a fix either side of the date line.  The watch should hear
+// only of real moves, one message each, and a failed send must be retried
+// by the next fix.
+
+var phoneLocation = require('../../src/pkjs/phone_location');
+
+var INBOX_SIZE = 128; // app_message_open() in main.c
+
+function dictSize(message) {
+  return 1 + Object.keys(message).length * (7 + 4);
+}
+
+function MockStorage() {
+  this.items = {};
+}
+MockStorage.prototype.getItem = function(key) {
+  return this.items.hasOwnProperty(key) ? this.items[key] : null;
+};
+MockStorage.prototype.setItem = function(key, value) {
+  this.items[key] = String(value);
+};
+
+function MockPebble() {
+  this.sent = [];
+  this.attempts = 0;
+  this.failNext = false;
+}
+MockPebble.prototype.sendAppMessage = function(message, success, failure) {
+  this.attempts++;
+  if (this.failNext) {
+    this.failNext = false;
+    failure({ error: 'mock drop' });
+    return;
+  }
+  this.sent.push(message);
+  success({});
+};
+
+var ok = true;
+function expect(condition, what) {
+  if (!condition) {
+    console.log('FAILED: ' + what);
+    ok = false;
+  }
+}
+
+var pebble = new MockPebble();
+var storage = new MockStorage();
+var fixes = 0;
+function fix(latitude, longitude) {
+  fixes++;
+  phoneLocation.update(pebble, storage, { latitude: latitude, longitude: longitude });
+}
+
+// a day at home with jitter, then a drive north and back
+var home = { latitude: 64.84, longitude: -147.72 };
+for (var i = 0; i < 96; i++) {
+  var jitter = ((i * 7919) % 11 - 5) / 100;
+  fix(home.latitude + jitter, home.longitude - jitter);
+}
+expect(pebble.sent.length === 1, 'jitter at home sends once, sent ' + pebble.sent.length);
+for (var step = 1; step <= 8; step++) {
+  fix(home.latitude + step * 0.25, home.longitude);
+}
+for (step = 7; step >= 0; step--) {
+  fix(home.latitude + step * 0.25, home.longitude);
+}
+var afterDrive = pebble.sent.length;
+expect(afterDrive === 9, 'drive of 2 degrees and back sends 9, sent ' + afterDrive);
+
+// a failed send is retried by the next fix
+pebble.failNext = true;
+fix(10, 20);
+expect(pebble.sent.length === afterDrive, 'failed send is not counted');
+fix(10, 20);
+expect(pebble.sent.length === afterDrive + 1, 'next fix retries the failed send');
+
+// 179.9E to 179.9W is 0.2 degrees, not 359.8
+fix(0, 179.9);
+var beforeDateLine = pebble.sent.length;
+fix(0, -179.9);
+expect(pebble.sent.length === beforeDateLine, 'date line crossing of 0.2 degrees sends nothing');
+
+var last = pebble.sent[pebble.sent.length - 1];
+expect(last.PhoneLatitude === 0 && last.PhoneLongitude === 17990, 'hundredths of a degree');
+pebble.sent.forEach(function(message) {
+  expect(dictSize(message) <= INBOX_SIZE, 'message fits the inbox');
+});
+
+console.log(fixes + ' fixes, ' + pebble.sent.length + ' messages in ' + pebble.attempts +
+            ' attempts, ' + dictSize(last) + '/' + INBOX_SIZE + ' bytes each' +
+            (ok ? '' : ', FAILED'));
+if (!ok) {
+  process.exitCode = 1;
+}
@@ -0,0 +1,92 @@
+// Exercise src/pkjs/sky_tables.js under node with a mock Pebble object.
+//
+// Run from the repository root:
+//
+//   node tools/pkjs/check_sky_tables.js
+//
+// The mock measures every AppMessage the way the watch's inbox sees it (a
+// one byte header, then per tuple a 7 byte header and its data; numbers go
+// as int32), drops some sends to exercise the retries, and decodes the
+// accepted rows the way sky_link.c does.  The decoded grids must equal the
+// phone's own, and no message may outgrow the 128 byte inbox.
+
+var skyTables = require('../../src/pkjs/sky_tables');
+
+var INBOX_SIZE = 128; // app_message_open() in main.c
+
+function dictSize(message) {
+  var size = 1;
+  Object.keys(message).forEach(function(key) {
+    var value = message[key];
+    size += 7 + (Array.isArray(value) ? value.length : 4);
+  });
+  return size;
+}
+
+function MockPebble(dropEvery) {
+  this.sent = [];
+  this.attempts = 0;
+  this.largest = 0;
+  this.dropEvery = dropEvery;
+}
+
+MockPebble.prototype.sendAppMessage = function(message, success, failure) {
+  var self = this;
+  self.attempts++;
+  self.largest = Math.max(self.largest, dictSize(message));
+  // answer asynchronously, as the phone does
+  setTimeout(function() {
+    if (self.dropEvery && (self.attempts % self.dropEvery === 0)) {
+      failure({ error: 'mock drop' });
+    }
+    else {
+      self.sent.push(message);
+      success({});
+    }
+  }, 0);
+};
+
+// What sky_link.c does with the rows
+function decode(messages) {
+  var grids = {};
+  grids[skyTables.SUN] = [];
+  grids[skyTables.MOON] = [];
+  messages.forEach(function(m) {
+    var grid = grids[m.SkyBody];
+    if (m.SkyRow !== grid.length) {
+      throw new Error('rows out of order at ' + m.SkyRow);
+    }
+    for (var i = 0; i < m.SkyData.length; i += 2) {
+      var value = m.SkyData[i] | (m.SkyData[i + 1] << 8);
+      grid.push(value >= 0x8000 ? value - 0x10000 : value);
+    }
+  });
+  return grids;
+}
+
+function check(name, payload, dropEvery) {
+  var pebble = new MockPebble(dropEvery);
+  var started = Date.now();
+  skyTables.answerRequest(pebble, payload, function(sent) {
+    var grids = decode(pebble.sent);
+    var lat = payload.SkyLatitude / 100, lon = payload.SkyLongitude / 100;
+    var solar = skyTables.elevationGrid(skyTables.SUN, payload.SkyRequest, skyTables.SOLAR_ROWS, lat, lon);
+    var lunar = skyTables.elevationGrid(skyTables.MOON,
+                                        payload.SkyRequest - skyTables.LUNAR_LEAD_HOURS * 3600,
+                                        skyTables.LUNAR_ROWS, lat, lon);
+    var same = (JSON.stringify(grids[skyTables.SUN]) === JSON.stringify(solar)) &&
+               (JSON.stringify(grids[skyTables.MOON]) === JSON.stringify(lunar));
+    console.log(name + ': ' + (sent ? 'sent' : 'gave up') + ', ' + pebble.sent.length + ' messages in ' +
+                pebble.attempts + ' attempts, largest ' + pebble.largest + '/' + INBOX_SIZE + ' bytes, ' +
+                (grids[skyTables.SUN].length + grids[skyTables.MOON].length) + ' rows, ' +
+                (same ? 'decoded grids match' : 'DECODED GRIDS DIFFER') + ', ' +
+                (Date.now() - started) + ' ms');
+    if (!sent || !same || pebble.largest > INBOX_SIZE) {
+      process.exitCode = 1;
+    }
+  });
+}
+
+// 2024-06-21 local midnight in Fairbanks (UTC-8), and a southern location
+check('fairbanks', { SkyRequest: 1718956800, SkyLatitude: 6480, SkyLongitude: -14700 }, 0);
+check('sydney, dropping every 3rd send', { SkyRequest: 1718892000, SkyLatitude: -3390, SkyLongitude: 15120 }, 3);
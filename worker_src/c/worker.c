@@ -0,0 +1,91 @@
+#include <pebble_worker.h>
+#include "ephemeris.h"
+#include "sky_store.h"
+#include "sky_worker.h"
+#include "sky_clock.h"
+#include "profile.h"
+//
+// Background worker for "ephemeris": keeps the next days of sky path grids
+// for the face's location saved at SKY_WORKER_STORE_KEY, so the face swaps
+// them in rather than computing them itself.  See src/c/sky_worker.h.
+//
+
+// the store handed to the face, and where it is for
+static SkyStore s_handoff;
+static Observer s_place;
+static bool s_placed = false;
+static uint32_t s_worker_fills = 0;
+
+// Local midnight at or before unixtime
+static time_t prv_midnight(time_t unixtime) {
+  struct tm *day = localtime(&unixtime);
+  day->tm_hour = 0;
+  day->tm_min = 0;
+  day->tm_sec = 0;
+  return mktime(day);
+}
+
+// Fill the handoff store if it no longer covers today and tomorrow.  Tell
+// the face when it did, or whenever reply is set.
+static void prv_refresh(bool reply) {
+  if (!s_placed)
+    return;
+  time_t today = prv_midnight(sky_clock_now());
+  time_t tomorrow = prv_midnight(today + SECS_IN_DAY + SECS_IN_HOUR);
+  int16_t table[25];
+  if (!sky_store_table(&s_handoff, &s_place, SKY_BODY_SUN, today, table) ||
+      !sky_store_table(&s_handoff, &s_place, SKY_BODY_SUN, tomorrow, table)) {
+    sky_store_fill(&s_handoff, &s_place, today);
+    sky_store_save(&s_handoff, SKY_WORKER_STORE_KEY);
+    s_worker_fills++;
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "Worker filled sky paths for %d days", SKY_STORE_DAYS);
+    reply = true;
+  }
+  if (reply) {
+    AppWorkerMessage message = { 0 };
+    app_worker_send_message(SKY_WORKER_MSG_READY, &message);
+  }
+}
+
+static void prv_set_place(float latitude, float longitude) {
+  if (s_placed)
+    observer_set(&s_place, latitude, longitude);
+  else
+    observer_init(&s_place, latitude, longitude);
+  s_placed = true;
+}
+
+static void prv_message_handler(uint16_t type, AppWorkerMessage *message) {
+  if (type != SKY_WORKER_MSG_PLACE)
+    return;
+  prv_set_place((float)(int16_t)message->data0 / SKY_STORE_STEPS_PER_DEGREE,
+                (float)(int16_t)message->data1 / SKY_STORE_STEPS_PER_DEGREE);
+  prv_refresh(true);
+}
+
+// the days roll on while the face is closed
+static void prv_hour_handler(struct tm *tick_time, TimeUnits units_changed) {
+  prv_refresh(false);
+}
+
+static void prv_init() {
+  // carry on for the location of the last store
+  if (sky_store_load(&s_handoff, SKY_WORKER_STORE_KEY))
+    prv_set_place(s_handoff.latitude, s_handoff.longitude);
+  app_worker_message_subscribe(prv_message_handler);
+  tick_timer_service_subscribe(HOUR_UNIT, prv_hour_handler);
+  AppWorkerMessage message = { 0 };
+  app_worker_send_message(SKY_WORKER_MSG_STARTED, &message);
+  prv_refresh(false);
+}
+
+static void prv_deinit() {
+  app_worker_message_unsubscribe();
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Worker sky path fills %d", (int)s_worker_fills);
+}
+
+int main(void) {
+  prv_init();
+  worker_event_loop();
+  prv_deinit();
+}